@@ -0,0 +1,123 @@
+// Multi-threaded pass stress test
+// - Many impls and associated type projections (in generic and concrete bodies), so that the parallel HIR passes
+//   (see `--threads`) hit the trait resolution caches and the crate impl indexes from several threads at once.
+// - Built without libcore so it can be compiled without the rustc source tree, see `make test_threads`
+#![feature(no_core,lang_items)]
+#![no_core]
+#![crate_type="rlib"]
+#![crate_name="threads"]
+
+#[lang="sized"] pub trait Sized {}
+#[lang="copy"] pub trait Copy {}
+#[lang="unsize"] pub trait Unsize<T: ?Sized> {}
+#[lang="coerce_unsized"] pub trait CoerceUnsized<T> {}
+#[lang="fn_once"] pub trait FnOnce<Args> { type Output; extern "rust-call" fn call_once(self, args: Args) -> Self::Output; }
+#[lang="fn_mut"] pub trait FnMut<Args>: FnOnce<Args> { extern "rust-call" fn call_mut(&mut self, args: Args) -> Self::Output; }
+#[lang="fn"] pub trait Fn<Args>: FnMut<Args> { extern "rust-call" fn call(&self, args: Args) -> Self::Output; }
+#[lang="deref"] pub trait Deref { type Target: ?Sized; fn deref(&self) -> &Self::Target; }
+#[lang="drop"] pub trait Drop { fn drop(&mut self); }
+#[lang="index"] pub trait Index<Idx: ?Sized> { type Output: ?Sized; fn index(&self, index: Idx) -> &Self::Output; }
+#[lang="index_mut"] pub trait IndexMut<Idx: ?Sized>: Index<Idx> { fn index_mut(&mut self, index: Idx) -> &mut Self::Output; }
+#[lang="neg"] pub trait Neg { type Output; fn neg(self) -> Self::Output; }
+#[lang="not"] pub trait Not { type Output; fn not(self) -> Self::Output; }
+#[lang="range"] pub struct Range<Idx> { pub start: Idx, pub end: Idx }
+
+#[lang="add"] pub trait Add<RHS=Self> { type Output; fn add(self, rhs: RHS) -> Self::Output; }
+impl Copy for u32 {}
+impl Add for u32 { type Output = u32; fn add(self, rhs: u32) -> u32 { self + rhs } }
+
+pub trait Value { fn value(&self) -> u32; }
+impl Value for u32 { fn value(&self) -> u32 { *self } }
+
+/// Type-level mapping, each impl is looked up via a projection
+pub trait Map { type Out: Value; fn map(&self) -> Self::Out; }
+/// Chained projection (`<<T as Map>::Out as Wrap>::Inner`)
+pub trait Wrap { type Inner: Value; fn unwrap(self) -> Self::Inner; }
+impl Wrap for u32 { type Inner = u32; fn unwrap(self) -> u32 { self } }
+
+pub fn through<T: Map>(v: &T) -> <T as Map>::Out {
+    v.map()
+}
+pub fn through_twice<T: Map>(v: &T) -> u32
+where
+    <T as Map>::Out: Wrap,
+{
+    let c = |x: <T as Map>::Out| x.unwrap().value();
+    c(v.map())
+}
+pub fn apply<T: Map, F: Fn(<T as Map>::Out) -> u32>(v: &T, f: F) -> u32 {
+    f(v.map())
+}
+
+macro_rules! types {
+    ( $( $name:ident => $val:expr, )* ) => {
+        $(
+            pub struct $name(pub u32);
+            impl Copy for $name {}
+            impl Value for $name { fn value(&self) -> u32 { self.0 + $val } }
+            impl Map for $name { type Out = u32; fn map(&self) -> u32 { self.value() } }
+            impl Add<u32> for $name { type Output = $name; fn add(self, rhs: u32) -> $name { $name(self.0 + rhs) } }
+            impl $name {
+                pub fn run(&self) -> u32 {
+                    let a = through(self);
+                    let b = through_twice(self);
+                    let c = apply(self, |x| x + a);
+                    let mut n = 0u32;
+                    { let mut inc = |v: u32| n = n + v; inc(a); inc(b); inc(c); }
+                    (*self + n).value()
+                }
+            }
+        )*
+        pub fn run_all() -> u32 {
+            0u32 $( + $name(1u32).run() )*
+        }
+    };
+}
+
+/// Generic wrapper, impls for this need to resolve the inner projections
+pub struct Pair<A, B>(pub A, pub B);
+impl<A: Map, B: Map> Map for Pair<A, B>
+where
+    <A as Map>::Out: Add<u32, Output=u32>,
+{
+    type Out = u32;
+    fn map(&self) -> u32 {
+        let f = |b: <B as Map>::Out| b.value();
+        self.0.map() + f(self.1.map())
+    }
+}
+impl<A: Value, B: Value> Value for Pair<A, B> {
+    fn value(&self) -> u32 { self.0.value() + self.1.value() }
+}
+
+pub mod a {
+    use {Map, Value, Add, Copy, through, through_twice, apply};
+    types! {
+        A0 => 0u32, A1 => 1u32, A2 => 2u32, A3 => 3u32, A4 => 4u32, A5 => 5u32, A6 => 6u32, A7 => 7u32,
+        A8 => 8u32, A9 => 9u32, A10 => 10u32, A11 => 11u32, A12 => 12u32, A13 => 13u32, A14 => 14u32, A15 => 15u32,
+    }
+}
+pub mod b {
+    use {Map, Value, Add, Copy, through, through_twice, apply};
+    types! {
+        B0 => 0u32, B1 => 1u32, B2 => 2u32, B3 => 3u32, B4 => 4u32, B5 => 5u32, B6 => 6u32, B7 => 7u32,
+        B8 => 8u32, B9 => 9u32, B10 => 10u32, B11 => 11u32, B12 => 12u32, B13 => 13u32, B14 => 14u32, B15 => 15u32,
+    }
+}
+pub mod c {
+    use {Map, Value, Add, Copy, through, through_twice, apply};
+    types! {
+        C0 => 0u32, C1 => 1u32, C2 => 2u32, C3 => 3u32, C4 => 4u32, C5 => 5u32, C6 => 6u32, C7 => 7u32,
+        C8 => 8u32, C9 => 9u32, C10 => 10u32, C11 => 11u32, C12 => 12u32, C13 => 13u32, C14 => 14u32, C15 => 15u32,
+    }
+}
+
+pub fn pairs() -> u32 {
+    let p = Pair(a::A0(1u32), b::B1(2u32));
+    let q = Pair(c::C2(3u32), Pair(a::A3(4u32), c::C4(5u32)));
+    through(&p) + through_twice(&q) + apply(&p, |x| x + q.value())
+}
+
+pub fn run() -> u32 {
+    a::run_all() + b::run_all() + c::run_all() + pairs()
+}
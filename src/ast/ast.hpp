@@ -507,6 +507,8 @@ public:
     {
         bool    controls_dir = false;
         ::std::string   path = "!";
+        /// Set when the module's file has been located but parsing it was deferred (see Parse_Crate)
+        bool    load_pending = false;
     };
 
     FileInfo    m_file_info;
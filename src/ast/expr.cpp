@@ -38,7 +38,9 @@ void Expr::visit_nodes(NodeVisitor& v) const
 Expr Expr::clone() const
 {
     if( m_node ) {
-        return Expr( m_node->clone() );
+        Expr    rv( m_node->clone() );
+        rv.m_needs_expand = m_needs_expand;
+        return rv;
     }
     else {
         return Expr();
@@ -13,12 +13,16 @@ extern ::std::ostream& operator<<(::std::ostream& os, const ExprNode& node);
 class Expr
 {
     ::std::shared_ptr<ExprNode> m_node;
+    /// Cleared by the parser when the expression contains nothing for the expand pass to do
+    bool    m_needs_expand = true;
 public:
     Expr(unique_ptr<ExprNode> node);
     Expr(ExprNode* node);
     Expr();
 
     bool is_valid() const { return m_node.get() != nullptr; }
+    bool needs_expand() const { return m_needs_expand; }
+    void set_needs_expand(bool v) { m_needs_expand = v; }
     const ExprNode& node() const { assert(m_node.get()); return *m_node; }
           ExprNode& node()       { assert(m_node.get()); return *m_node; }
     ::std::shared_ptr<ExprNode> take_node() { assert(m_node.get()); return ::std::move(m_node); }
@@ -246,6 +246,29 @@ struct Deriver
 
         out_list.push_back(type.clone());
     }
+
+    /// Enums with at least this many variants get compact derive code. Data-less variants are handled by comparing
+    /// or hashing the discriminant, instead of each getting an arm (or an arm for every pair of variants).
+    static const unsigned int COMPACT_ENUM_MIN_VARIANTS = 4;
+
+    bool use_compact_enum(const AST::Enum& enm) const
+    {
+        return enm.variants().size() >= COMPACT_ENUM_MIN_VARIANTS;
+    }
+    /// `unsafe { ::core::intrinsics::discriminant_value(<name>) }` (the variant's discriminant value, as u64)
+    AST::ExprNodeP get_discriminant(const ::std::string& core_name, const ::std::string& name) const
+    {
+        return NEWNODE(Block, true, true, vec$(
+            NEWNODE(CallPath, AST::Path(core_name, { AST::PathNode("intrinsics", {}), AST::PathNode("discriminant_value", {}) }),
+                vec$( NEWNODE(NamedValue, AST::Path(name)) )
+                )
+            ), nullptr);
+    }
+    /// `<discriminant> as isize`, used for ordering (so negative discriminants sort first, same as rustc's derive)
+    AST::ExprNodeP get_discriminant_ord(const Span& sp, const ::std::string& core_name, const ::std::string& name) const
+    {
+        return NEWNODE(Cast, this->get_discriminant(core_name, name), TypeRef(sp, CORETYPE_INT));
+    }
 };
 
 /// 'Debug' derive handler
@@ -511,12 +534,18 @@ public:
         base_path.nodes().back().args() = ::AST::PathParams();
         ::std::vector<AST::ExprNode_Match_Arm>   arms;
 
+        bool compact = this->use_compact_enum(enm);
+
         for(const auto& v : enm.variants())
         {
             AST::ExprNodeP  code;
             AST::Pattern    pat_a;
             AST::Pattern    pat_b;
 
+            // Data-less variants are handled by the discriminant check in the default arm
+            if( compact && v.m_data.is_Value() )
+                continue ;
+
             TU_MATCH(::AST::EnumVariantData, (v.m_data), (e),
             (Value,
                 code = NEWNODE(Bool, true);
@@ -589,7 +618,9 @@ public:
             arms.push_back(AST::ExprNode_Match_Arm(
                 ::make_vec1( AST::Pattern() ),
                 nullptr,
-                NEWNODE(Bool, false)
+                compact
+                    ? NEWNODE(BinOp, AST::ExprNode_BinOp::CMPEQU, this->get_discriminant(core_name, "self"), this->get_discriminant(core_name, "v"))
+                    : NEWNODE(Bool, false)
                 ));
         }
 
@@ -716,12 +747,18 @@ public:
         base_path.nodes().back().args() = ::AST::PathParams();
         ::std::vector<AST::ExprNode_Match_Arm>   arms;
 
+        bool compact = this->use_compact_enum(enm);
+
         for(const auto& v : enm.variants())
         {
             AST::ExprNodeP  code;
             AST::Pattern    pat_a;
             AST::Pattern    pat_b;
 
+            // Data-less variants are handled by the discriminant comparison in the default arm
+            if( compact && v.m_data.is_Value() )
+                continue ;
+
             TU_MATCH(::AST::EnumVariantData, (v.m_data), (e),
             (Value,
                 code = this->make_ret_equal(core_name);
@@ -791,6 +828,21 @@ public:
                 ));
         }
 
+        if( compact )
+        {
+            // Different variants (or the same data-less variant): order by discriminant value
+            arms.push_back(AST::ExprNode_Match_Arm(
+                ::make_vec1( AST::Pattern() ),
+                nullptr,
+                NEWNODE(CallPath, this->get_path(core_name, "cmp", "PartialOrd", "partial_cmp"),
+                    ::make_vec2(
+                        NEWNODE(UniOp, AST::ExprNode_UniOp::REF, this->get_discriminant_ord(sp, core_name, "self")),
+                        NEWNODE(UniOp, AST::ExprNode_UniOp::REF, this->get_discriminant_ord(sp, core_name, "v"))
+                        )
+                    )
+                ));
+        }
+        else
         for(unsigned int a = 0; a < enm.variants().size(); a ++ )
         {
             for(unsigned int b = 0; b < enm.variants().size(); b ++ )
@@ -1080,12 +1132,18 @@ public:
         base_path.nodes().back().args() = ::AST::PathParams();
         ::std::vector<AST::ExprNode_Match_Arm>   arms;
 
+        bool compact = this->use_compact_enum(enm);
+
         for(const auto& v : enm.variants())
         {
             AST::ExprNodeP  code;
             AST::Pattern    pat_a;
             AST::Pattern    pat_b;
 
+            // Data-less variants are handled by the discriminant comparison in the default arm
+            if( compact && v.m_data.is_Value() )
+                continue ;
+
             TU_MATCH(::AST::EnumVariantData, (v.m_data), (e),
             (Value,
                 code = this->make_ret_equal(core_name);
@@ -1155,6 +1213,21 @@ public:
                 ));
         }
 
+        if( compact )
+        {
+            // Different variants (or the same data-less variant): order by discriminant value
+            arms.push_back(AST::ExprNode_Match_Arm(
+                ::make_vec1( AST::Pattern() ),
+                nullptr,
+                NEWNODE(CallPath, this->get_path(core_name, "cmp", "Ord", "cmp"),
+                    ::make_vec2(
+                        NEWNODE(UniOp, AST::ExprNode_UniOp::REF, this->get_discriminant_ord(sp, core_name, "self")),
+                        NEWNODE(UniOp, AST::ExprNode_UniOp::REF, this->get_discriminant_ord(sp, core_name, "v"))
+                        )
+                    )
+                ));
+        }
+        else
         for(unsigned int a = 0; a < enm.variants().size(); a ++ )
         {
             for(unsigned int b = 0; b < enm.variants().size(); b ++ )
@@ -1545,13 +1618,27 @@ public:
         base_path.nodes().back().args() = ::AST::PathParams();
         ::std::vector<AST::ExprNode_Match_Arm>   arms;
 
+        // Compact: Hash the discriminant once up-front (as usize, equal to the per-arm variant index hash unless there are
+        // explicit discriminants) and only match data variants
+        bool compact = this->use_compact_enum(enm);
+        ::std::vector<AST::ExprNodeP>   top_nodes;
+        if( compact )
+        {
+            top_nodes.push_back( this->hash_val_ref(core_name,
+                NEWNODE(Cast, this->get_discriminant(core_name, "self"), TypeRef(sp, CORETYPE_UINT))
+                ) );
+        }
+
         for(unsigned int var_idx = 0; var_idx < enm.variants().size(); var_idx ++)
         {
             const auto& v = enm.variants()[var_idx];
             AST::ExprNodeP  code;
             AST::Pattern    pat_a;
 
-            auto var_idx_hash = this->hash_val_ref( core_name, NEWNODE(Integer, var_idx, CORETYPE_UINT) );
+            if( compact && v.m_data.is_Value() )
+                continue ;
+
+            auto var_idx_hash = compact ? AST::ExprNodeP() : this->hash_val_ref( core_name, NEWNODE(Integer, var_idx, CORETYPE_UINT) );
 
             TU_MATCH(::AST::EnumVariantData, (v.m_data), (e),
             (Value,
@@ -1561,7 +1648,8 @@ public:
             (Tuple,
                 ::std::vector<AST::Pattern>    pats_a;
                 ::std::vector<AST::ExprNodeP>   nodes;
-                nodes.push_back( mv$(var_idx_hash) );
+                if( var_idx_hash )
+                    nodes.push_back( mv$(var_idx_hash) );
 
                 for( unsigned int idx = 0; idx < e.m_sub_types.size(); idx ++ )
                 {
@@ -1576,7 +1664,8 @@ public:
             (Struct,
                 ::std::vector< ::std::pair<std::string, AST::Pattern> > pats_a;
                 ::std::vector< AST::ExprNodeP >   nodes;
-                nodes.push_back( mv$(var_idx_hash) );
+                if( var_idx_hash )
+                    nodes.push_back( mv$(var_idx_hash) );
 
                 for( const auto& fld : e.m_fields )
                 {
@@ -1600,6 +1689,20 @@ public:
                 ));
         }
 
+        if( compact )
+        {
+            if( !arms.empty() )
+            {
+                arms.push_back(AST::ExprNode_Match_Arm(
+                    ::make_vec1( AST::Pattern() ),
+                    nullptr,
+                    NEWNODE(Tuple, ::std::vector<AST::ExprNodeP>())
+                    ));
+                top_nodes.push_back( NEWNODE(Match, NEWNODE(NamedValue, AST::Path("self")), mv$(arms)) );
+            }
+            return this->make_ret(sp, core_name, p, type, this->get_field_bounds(enm), NEWNODE(Block, mv$(top_nodes)));
+        }
+
         return this->make_ret(sp, core_name, p, type, this->get_field_bounds(enm), NEWNODE(Match,
             NEWNODE(NamedValue, AST::Path("self")),
             mv$(arms)
@@ -14,7 +14,7 @@ class CExpanderFile:
 {
     ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
-        return box$( TTStreamO(TokenTree(Token(TOK_STRING, sp.filename.c_str()))) );
+        return box$( TTStreamO(TokenTree(Token(TOK_STRING, sp.filename().c_str()))) );
     }
 };
 
@@ -23,7 +23,7 @@ class CExpanderLine:
 {
     ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
-        return box$( TTStreamO(TokenTree(Token((uint64_t)sp.start_line, CORETYPE_U32))) );
+        return box$( TTStreamO(TokenTree(Token((uint64_t)sp.start_line(), CORETYPE_U32))) );
     }
 };
 
@@ -32,7 +32,7 @@ class CExpanderColumn:
 {
     ::std::unique_ptr<TokenStream> expand(const Span& sp, const AST::Crate& crate, const ::std::string& ident, const TokenTree& tt, AST::Module& mod) override
     {
-        return box$( TTStreamO(TokenTree(Token((uint64_t)sp.start_ofs, CORETYPE_U32))) );
+        return box$( TTStreamO(TokenTree(Token((uint64_t)sp.start_ofs(), CORETYPE_U32))) );
     }
 };
 
@@ -429,6 +429,116 @@ namespace {
         toks.push_back( mv$(t3) );
         toks.push_back( mv$(t4) );
     }
+
+    /// Statics created for format pieces/specs, keyed on the owning module and the static's contents.
+    /// Identical format strings within a module share one static, instead of each invocation emitting its own.
+    ::std::map< ::std::string, ::AST::Path>    g_shared_statics;
+
+    /// Obtain the path to a `static` in `mod` with the given type and value, creating it if not already present
+    ::AST::Path get_shared_static(AST::Module& mod, const char* name_prefix, const ::std::string& key, ::std::vector<TokenTree> ty, ::std::vector<TokenTree> val)
+    {
+        auto full_key = FMT(mod.path() << "\n" << name_prefix << "\n" << key);
+        auto it = g_shared_statics.find(full_key);
+        if( it != g_shared_statics.end() )
+            return it->second;
+
+        // NOTE: `#` in the name prevents collisions with user items
+        auto name = FMT(name_prefix << "#" << g_shared_statics.size());
+        DEBUG("New static " << name << " in " << mod.path());
+
+        ::std::vector<TokenTree> toks;
+        toks.push_back( TokenTree(TOK_RWORD_STATIC) );
+        toks.push_back( Token(TOK_IDENT, name) );
+        toks.push_back( TokenTree(TOK_COLON) );
+        for(auto& t : ty)
+            toks.push_back( mv$(t) );
+        toks.push_back( TokenTree(TOK_EQUAL) );
+        for(auto& t : val)
+            toks.push_back( mv$(t) );
+        toks.push_back( TokenTree(TOK_SEMICOLON) );
+
+        TTStreamO   lex( TokenTree(Ident::Hygiene::new_scope(), mv$(toks)) );
+        SET_MODULE(lex, mod);
+        Parse_ModRoot_Items(lex, mod);
+
+        auto path = mod.path() + name;
+        g_shared_statics.insert( ::std::make_pair(mv$(full_key), path) );
+        return path;
+    }
+
+    /// Push a `fmt::rt::v1::Argument` literal for the given fragment
+    void push_spec(::std::vector<TokenTree>& toks, const AST::Crate& crate, const FmtFrag& frag)
+    {
+        push_path(toks, crate, {"fmt", "rt", "v1", "Argument"});
+        toks.push_back( TokenTree(TOK_BRACE_OPEN) );
+
+        push_toks(toks, Token(TOK_IDENT, "position"), TOK_COLON );
+        push_path(toks, crate, {"fmt", "rt", "v1", "Position", "Next"});
+        push_toks(toks, TOK_COMMA);
+
+        push_toks(toks, Token(TOK_IDENT, "format"), TOK_COLON );
+        push_path(toks, crate, {"fmt", "rt", "v1", "FormatSpec"});
+        toks.push_back( TokenTree(TOK_BRACE_OPEN) );
+        {
+            push_toks(toks, Token(TOK_IDENT, "fill"), TOK_COLON, Token(uint64_t(frag.args.align_char), CORETYPE_CHAR), TOK_COMMA );
+
+            push_toks(toks, Token(TOK_IDENT, "align"), TOK_COLON);
+            const char* align_var_name = nullptr;
+            switch( frag.args.align )
+            {
+            case FmtArgs::Align::Unspec:    align_var_name = "Unknown"; break;
+            case FmtArgs::Align::Left:      align_var_name = "Left";    break;
+            case FmtArgs::Align::Center:    align_var_name = "Center";  break;
+            case FmtArgs::Align::Right:     align_var_name = "Right";   break;
+            }
+            push_path(toks, crate, {"fmt", "rt", "v1", "Alignment", align_var_name});
+            push_toks(toks, TOK_COMMA);
+
+            push_toks(toks, Token(TOK_IDENT, "flags"), TOK_COLON);
+            uint64_t flags = 0;
+            if(frag.args.alternate)
+                flags |= 1 << 2;
+            push_toks(toks, Token(uint64_t(flags), CORETYPE_U32));
+            push_toks(toks, TOK_COMMA);
+
+            push_toks(toks, Token(TOK_IDENT, "precision"), TOK_COLON );
+            if( frag.args.prec_is_arg || frag.args.prec != 0 ) {
+                push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Is"});
+                push_toks(toks, TOK_PAREN_OPEN);
+                if( frag.args.prec_is_arg ) {
+                    push_toks(toks, TOK_STAR, Token(TOK_IDENT, FMT("a" << frag.args.prec)) );
+                }
+                else {
+                    push_toks(toks, Token(uint64_t(frag.args.prec), CORETYPE_UINT) );
+                }
+                toks.push_back( TokenTree(TOK_PAREN_CLOSE) );
+            }
+            else {
+                push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Implied"});
+            }
+            toks.push_back( TokenTree(TOK_COMMA) );
+
+            push_toks(toks, Token(TOK_IDENT, "width"), TOK_COLON );
+            if( frag.args.width_is_arg || frag.args.width != 0 ) {
+                push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Is"});
+                push_toks(toks, TOK_PAREN_OPEN);
+                if( frag.args.width_is_arg ) {
+                    push_toks(toks, TOK_STAR, Token(TOK_IDENT, FMT("a" << frag.args.width)) );
+                }
+                else {
+                    push_toks(toks, Token(uint64_t(frag.args.width), CORETYPE_UINT) );
+                }
+                toks.push_back( TokenTree(TOK_PAREN_CLOSE) );
+            }
+            else {
+                push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Implied"});
+            }
+            toks.push_back( TokenTree(TOK_COMMA) );
+        }
+        toks.push_back( TokenTree(TOK_BRACE_CLOSE) );
+
+        toks.push_back( TokenTree(TOK_BRACE_CLOSE) );
+    }
 }
 
 class CFormatArgsExpander:
@@ -537,33 +647,33 @@ class CFormatArgsExpander:
         toks.push_back( TokenTree(TOK_FATARROW) );
         toks.push_back( TokenTree(TOK_BRACE_OPEN) );
 
-        // Save fragments into a static
-        // `static FRAGMENTS: [&'static str; N] = [...];`
+        // Save fragments into a static (shared with other invocations in this module)
+        // `static FORMAT_PIECES#n: [&'static str; N+1] = [...];`
         // - Contains N+1 entries, where N is the number of fragments
+        ::AST::Path pieces_path;
         {
-            toks.push_back( TokenTree(TOK_RWORD_STATIC) );
-            toks.push_back( Token(TOK_IDENT, "FRAGMENTS") );
-            toks.push_back( TokenTree(TOK_COLON) );
-
-            toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
-            toks.push_back( Token(TOK_AMP) );
-            toks.push_back( Token(TOK_LIFETIME, "static") );
-            toks.push_back( Token(TOK_IDENT, "str") );
-            toks.push_back( Token(TOK_SEMICOLON) );
-            toks.push_back( Token(fragments.size() + 1, CORETYPE_UINT) );
-            toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
-
-            toks.push_back( Token(TOK_EQUAL) );
-
-            toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
+            ::std::vector<TokenTree>    ty_toks;
+            ty_toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
+            ty_toks.push_back( Token(TOK_AMP) );
+            ty_toks.push_back( Token(TOK_LIFETIME, "static") );
+            ty_toks.push_back( Token(TOK_IDENT, "str") );
+            ty_toks.push_back( Token(TOK_SEMICOLON) );
+            ty_toks.push_back( Token(fragments.size() + 1, CORETYPE_UINT) );
+            ty_toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
+
+            ::std::stringstream key;
+            ::std::vector<TokenTree>    val_toks;
+            val_toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
             for(const auto& frag : fragments ) {
-                toks.push_back( Token(TOK_STRING, frag.leading_text) );
-                toks.push_back( TokenTree(TOK_COMMA) );
+                key << frag.leading_text.size() << ":" << frag.leading_text;
+                val_toks.push_back( Token(TOK_STRING, frag.leading_text) );
+                val_toks.push_back( TokenTree(TOK_COMMA) );
             }
-            toks.push_back( Token(TOK_STRING, tail) );
-            toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
+            key << tail.size() << ":" << tail;
+            val_toks.push_back( Token(TOK_STRING, tail) );
+            val_toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
 
-            toks.push_back( Token(TOK_SEMICOLON) );
+            pieces_path = get_shared_static(mod, "FORMAT_PIECES", key.str(), mv$(ty_toks), mv$(val_toks));
         }
 
         if( is_simple )
@@ -574,7 +684,7 @@ class CFormatArgsExpander:
             toks.push_back( TokenTree(TOK_PAREN_OPEN) );
             {
                 toks.push_back( TokenTree(TOK_AMP) );
-                toks.push_back( Token(TOK_IDENT, "FRAGMENTS") );
+                toks.push_back( Token(InterpolatedFragment(pieces_path)) );
                 toks.push_back( TokenTree(TOK_COMMA) );
 
                 toks.push_back( TokenTree(TOK_AMP) );
@@ -608,7 +718,7 @@ class CFormatArgsExpander:
             toks.push_back( TokenTree(TOK_PAREN_OPEN) );
             {
                 toks.push_back( TokenTree(TOK_AMP) );
-                toks.push_back( Token(TOK_IDENT, "FRAGMENTS") );
+                toks.push_back( Token(InterpolatedFragment(pieces_path)) );
                 toks.push_back( TokenTree(TOK_COMMA) );
 
                 // TODO: Fragments to format
@@ -630,82 +740,49 @@ class CFormatArgsExpander:
                 toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
                 toks.push_back( TokenTree(TOK_COMMA) );
 
-                toks.push_back( TokenTree(TOK_AMP) );
-                toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
+                // Specs that don't refer to arguments (for width/precision) are constant, so are also shared
+                bool specs_are_const = true;
                 for(const auto& frag : fragments)
                 {
-                    push_path(toks, crate, {"fmt", "rt", "v1", "Argument"});
-                    toks.push_back( TokenTree(TOK_BRACE_OPEN) );
-
-                    push_toks(toks, Token(TOK_IDENT, "position"), TOK_COLON );
-                    push_path(toks, crate, {"fmt", "rt", "v1", "Position", "Next"});
-                    push_toks(toks, TOK_COMMA);
+                    if( frag.args.width_is_arg || frag.args.prec_is_arg )
+                        specs_are_const = false;
+                }
 
-                    push_toks(toks, Token(TOK_IDENT, "format"), TOK_COLON );
-                    push_path(toks, crate, {"fmt", "rt", "v1", "FormatSpec"});
-                    toks.push_back( TokenTree(TOK_BRACE_OPEN) );
+                if( specs_are_const )
+                {
+                    ::std::vector<TokenTree>    ty_toks;
+                    ty_toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
+                    push_path(ty_toks, crate, {"fmt", "rt", "v1", "Argument"});
+                    ty_toks.push_back( Token(TOK_SEMICOLON) );
+                    ty_toks.push_back( Token(fragments.size(), CORETYPE_UINT) );
+                    ty_toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
+
+                    ::std::stringstream key;
+                    ::std::vector<TokenTree>    val_toks;
+                    val_toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
+                    for(const auto& frag : fragments)
                     {
-                        push_toks(toks, Token(TOK_IDENT, "fill"), TOK_COLON, Token(uint64_t(frag.args.align_char), CORETYPE_CHAR), TOK_COMMA );
-
-                        push_toks(toks, Token(TOK_IDENT, "align"), TOK_COLON);
-                        const char* align_var_name = nullptr;
-                        switch( frag.args.align )
-                        {
-                        case FmtArgs::Align::Unspec:    align_var_name = "Unknown"; break;
-                        case FmtArgs::Align::Left:      align_var_name = "Left";    break;
-                        case FmtArgs::Align::Center:    align_var_name = "Center";  break;
-                        case FmtArgs::Align::Right:     align_var_name = "Right";   break;
-                        }
-                        push_path(toks, crate, {"fmt", "rt", "v1", "Alignment", align_var_name});
-                        push_toks(toks, TOK_COMMA);
-
-                        push_toks(toks, Token(TOK_IDENT, "flags"), TOK_COLON);
-                        uint64_t flags = 0;
-                        if(frag.args.alternate)
-                            flags |= 1 << 2;
-                        push_toks(toks, Token(uint64_t(flags), CORETYPE_U32));
-                        push_toks(toks, TOK_COMMA);
-
-                        push_toks(toks, Token(TOK_IDENT, "precision"), TOK_COLON );
-                        if( frag.args.prec_is_arg || frag.args.prec != 0 ) {
-                            push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Is"});
-                            push_toks(toks, TOK_PAREN_OPEN);
-                            if( frag.args.prec_is_arg ) {
-                                push_toks(toks, TOK_STAR, Token(TOK_IDENT, FMT("a" << frag.args.prec)) );
-                            }
-                            else {
-                                push_toks(toks, Token(uint64_t(frag.args.prec), CORETYPE_UINT) );
-                            }
-                            toks.push_back( TokenTree(TOK_PAREN_CLOSE) );
-                        }
-                        else {
-                            push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Implied"});
-                        }
-                        toks.push_back( TokenTree(TOK_COMMA) );
+                        key << frag.args << ";";
+                        push_spec(val_toks, crate, frag);
+                        val_toks.push_back( TokenTree(TOK_COMMA) );
+                    }
+                    val_toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
 
-                        push_toks(toks, Token(TOK_IDENT, "width"), TOK_COLON );
-                        if( frag.args.width_is_arg || frag.args.width != 0 ) {
-                            push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Is"});
-                            push_toks(toks, TOK_PAREN_OPEN);
-                            if( frag.args.width_is_arg ) {
-                                push_toks(toks, TOK_STAR, Token(TOK_IDENT, FMT("a" << frag.args.width)) );
-                            }
-                            else {
-                                push_toks(toks, Token(uint64_t(frag.args.width), CORETYPE_UINT) );
-                            }
-                            toks.push_back( TokenTree(TOK_PAREN_CLOSE) );
-                        }
-                        else {
-                            push_path(toks, crate, {"fmt", "rt", "v1", "Count", "Implied"});
-                        }
+                    auto specs_path = get_shared_static(mod, "FORMAT_SPECS", key.str(), mv$(ty_toks), mv$(val_toks));
+                    toks.push_back( TokenTree(TOK_AMP) );
+                    toks.push_back( Token(InterpolatedFragment(specs_path)) );
+                }
+                else
+                {
+                    toks.push_back( TokenTree(TOK_AMP) );
+                    toks.push_back( TokenTree(TOK_SQUARE_OPEN) );
+                    for(const auto& frag : fragments)
+                    {
+                        push_spec(toks, crate, frag);
                         toks.push_back( TokenTree(TOK_COMMA) );
                     }
-                    toks.push_back( TokenTree(TOK_BRACE_CLOSE) );
-
-                    toks.push_back( TokenTree(TOK_BRACE_CLOSE) );
-                    toks.push_back( TokenTree(TOK_COMMA) );
+                    toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
                 }
-                toks.push_back( TokenTree(TOK_SQUARE_CLOSE) );
             }
             // )
             toks.push_back( TokenTree(TOK_PAREN_CLOSE) );
@@ -10,7 +10,11 @@
 #include <main_bindings.hpp>
 #include <synext.hpp>
 #include <map>
+#include <ctime>
+#include <iomanip>
+#include <algorithm>
 #include "macro_rules.hpp"
+#include <macro_rules/macro_rules.hpp>
 #include "../parse/common.hpp"  // For reparse from macros
 #include <ast/expr.hpp>
 #include "cfg.hpp"
@@ -23,6 +27,148 @@ void Expand_Mod(::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::
 void Expand_Expr(::AST::Crate& crate, LList<const AST::Module*> modstack, AST::Expr& node);
 void Expand_Expr(::AST::Crate& crate, LList<const AST::Module*> modstack, ::std::shared_ptr<AST::ExprNode>& node);
 
+// ------------------------------------------------------------------
+// Expansion profiling
+// ------------------------------------------------------------------
+namespace {
+    /// Statistics for a single macro / attribute
+    struct ExpandProfileEnt
+    {
+        const char* kind = "";
+        unsigned int    invocations = 0;
+        unsigned int    max_depth = 0;
+        unsigned long   total_depth = 0;
+        unsigned long   tokens_in = 0;
+        unsigned long   tokens_out = 0;
+        /// Time spent in the handler (pattern matching for macro_rules!)
+        double  time_expand = 0;
+        /// Time spent producing output tokens (transcription for macro_rules!)
+        double  time_output = 0;
+
+        double total_time() const { return time_expand + time_output; }
+    };
+    bool    g_expand_profile = false;
+    /// Profile entries, keyed on display name (e.g. `format_args!` or `#[derive]`)
+    ::std::map< ::std::string, ExpandProfileEnt>   g_expand_profile_ents;
+    /// Number of macro expansions whose output is currently being consumed (dynamic recursion depth)
+    unsigned int    g_expand_depth = 0;
+
+    double clock_diff(clock_t start) {
+        return static_cast<double>(clock() - start) / static_cast<double>(CLOCKS_PER_SEC);
+    }
+
+    unsigned long count_tt_tokens(const TokenTree& tt)
+    {
+        if( tt.size() == 0 )
+            return tt.tok().type() == TOK_NULL ? 0 : 1;
+        unsigned long rv = 0;
+        for(unsigned int i = 0; i < tt.size(); i ++)
+            rv += count_tt_tokens(tt[i]);
+        return rv;
+    }
+
+    /// Wraps the output of a macro, counting the tokens produced and the time taken to produce them
+    class ProfiledTokenStream:
+        public TokenStream
+    {
+        ::std::unique_ptr<TokenStream>  m_inner;
+        ExpandProfileEnt&   m_ent;
+    public:
+        ProfiledTokenStream(::std::unique_ptr<TokenStream> inner, ExpandProfileEnt& ent):
+            m_inner( mv$(inner) ),
+            m_ent( ent )
+        {
+            this->parse_state() = m_inner->parse_state();
+            g_expand_depth += 1;
+        }
+        ~ProfiledTokenStream()
+        {
+            g_expand_depth -= 1;
+        }
+
+        Position getPosition() const override {
+            return m_inner->getPosition();
+        }
+        Ident::Hygiene realGetHygiene() const override {
+            return m_inner->getHygiene();
+        }
+        Token realGetToken() override {
+            auto start = clock();
+            auto rv = m_inner->getToken();
+            m_ent.time_output += clock_diff(start);
+            if( rv.type() != TOK_EOF )
+                m_ent.tokens_out += 1;
+            return rv;
+        }
+    };
+
+    ExpandProfileEnt& profile_start(const ::std::string& name, const char* kind)
+    {
+        auto& ent = g_expand_profile_ents[name];
+        ent.kind = kind;
+        ent.invocations += 1;
+        ent.total_depth += g_expand_depth + 1;
+        ent.max_depth = ::std::max(ent.max_depth, g_expand_depth + 1);
+        return ent;
+    }
+}
+
+void Expand_EnableProfile()
+{
+    g_expand_profile = true;
+}
+void Expand_PrintProfile(::std::ostream& os, bool as_json)
+{
+    ::std::vector< const ::std::pair<const ::std::string, ExpandProfileEnt>* >  ents;
+    for(const auto& e : g_expand_profile_ents)
+        ents.push_back(&e);
+    ::std::sort(ents.begin(), ents.end(), [](const auto* a, const auto* b){ return a->second.total_time() > b->second.total_time(); });
+
+    if( as_json )
+    {
+        os << "[" << ::std::endl;
+        for(const auto* e : ents)
+        {
+            const auto& v = e->second;
+            os << " {\"name\": \"";
+            for(char c : e->first) {
+                if( c == '"' || c == '\\' )
+                    os << '\\';
+                os << c;
+            }
+            os << "\", \"kind\": \"" << v.kind << "\""
+                << ", \"invocations\": " << v.invocations
+                << ", \"max_depth\": " << v.max_depth
+                << ", \"total_depth\": " << v.total_depth
+                << ", \"tokens_in\": " << v.tokens_in
+                << ", \"tokens_out\": " << v.tokens_out
+                << ", \"time_expand\": " << v.time_expand
+                << ", \"time_output\": " << v.time_output
+                << "}" << (e == ents.back() ? "" : ",") << ::std::endl;
+        }
+        os << "]" << ::std::endl;
+    }
+    else
+    {
+        os << "Macro expansion profile (sorted by time):" << ::std::endl;
+        os << ::std::setw(10) << "Time(ms)" << ::std::setw(9) << "Calls" << ::std::setw(9) << "MaxDepth" << ::std::setw(9) << "AvgDepth"
+            << ::std::setw(11) << "TokensIn" << ::std::setw(11) << "TokensOut" << "  " << ::std::left << ::std::setw(12) << "Kind" << ::std::right << "Name"
+            << ::std::endl;
+        for(const auto* e : ents)
+        {
+            const auto& v = e->second;
+            os << ::std::fixed << ::std::setprecision(3) << ::std::setw(10) << v.total_time() * 1000
+                << ::std::setw(9) << v.invocations
+                << ::std::setw(9) << v.max_depth
+                << ::std::setprecision(1) << ::std::setw(9) << static_cast<double>(v.total_depth) / v.invocations
+                << ::std::setw(11) << v.tokens_in
+                << ::std::setw(11) << v.tokens_out
+                << "  " << ::std::left << ::std::setw(12) << v.kind << ::std::right << e->first
+                << ::std::endl;
+        }
+    }
+}
+
 void Register_Synext_Decorator(::std::string name, ::std::unique_ptr<ExpandDecorator> handler) {
     g_decorators[name] = mv$(handler);
 }
@@ -42,7 +188,15 @@ void Expand_Attr(const Span& sp, const ::AST::MetaItem& a, AttrStage stage,  ::s
         if( d.first == a.name() ) {
             DEBUG("#[" << d.first << "] " << (int)d.second->stage() << "-" << (int)stage);
             if( d.second->stage() == stage ) {
-                f(sp, *d.second, a);
+                if( g_expand_profile ) {
+                    auto& ent = profile_start(FMT("#[" << d.first << "]"), "attribute");
+                    auto start = clock();
+                    f(sp, *d.second, a);
+                    ent.time_expand += clock_diff(start);
+                }
+                else {
+                    f(sp, *d.second, a);
+                }
             }
         }
     }
@@ -74,14 +228,13 @@ void Expand_Attrs(::AST::MetaItems& attrs, AttrStage stage,  ::AST::Crate& crate
     Expand_Attrs(attrs, stage,  [&](const auto& sp, const auto& d, const auto& a){ d.handle(sp, a, crate, mod, impl); });
 }
 
-::std::unique_ptr<TokenStream> Expand_Macro(
+static ::std::unique_ptr<TokenStream> Expand_Macro_Inner(
     const ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Module& mod,
-    Span mi_span, const ::std::string& name, const ::std::string& input_ident, TokenTree& input_tt
+    Span mi_span, const ::std::string& name, const ::std::string& input_ident, TokenTree& input_tt,
+    const char*& out_kind
     )
 {
-    if( name == "" ) {
-        return ::std::unique_ptr<TokenStream>();
-    }
+    out_kind = "builtin";
 
     for( const auto& m : g_macros )
     {
@@ -105,6 +258,7 @@ void Expand_Attrs(::AST::MetaItems& attrs, AttrStage stage,  ::AST::Crate& crate
                 if( input_ident != "" )
                     ERROR(mi_span, E0000, "macro_rules! macros can't take an ident");
 
+                out_kind = "macro_rules";
                 auto e = Macro_Invoke(name.c_str(), *mr.data, mv$(input_tt), mod);
                 return e;
             }
@@ -118,6 +272,7 @@ void Expand_Attrs(::AST::MetaItems& attrs, AttrStage stage,  ::AST::Crate& crate
                 if( input_ident != "" )
                     ERROR(mi_span, E0000, "macro_rules! macros can't take an ident");
 
+                out_kind = "macro_rules";
                 auto e = Macro_Invoke(name.c_str(), *mri.data, mv$(input_tt), mod);
                 return e;
             }
@@ -127,6 +282,35 @@ void Expand_Attrs(::AST::MetaItems& attrs, AttrStage stage,  ::AST::Crate& crate
     // Error - Unknown macro name
     ERROR(mi_span, E0000, "Unknown macro '" << name << "'");
 }
+::std::unique_ptr<TokenStream> Expand_Macro(
+    const ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Module& mod,
+    Span mi_span, const ::std::string& name, const ::std::string& input_ident, TokenTree& input_tt
+    )
+{
+    if( name == "" ) {
+        return ::std::unique_ptr<TokenStream>();
+    }
+
+    const char* kind;
+    if( !g_expand_profile )
+    {
+        return Expand_Macro_Inner(crate, modstack, mod,  mi_span, name, input_ident, input_tt, kind);
+    }
+
+    auto tokens_in = count_tt_tokens(input_tt);
+    auto start = clock();
+    auto rv = Expand_Macro_Inner(crate, modstack, mod,  mi_span, name, input_ident, input_tt, kind);
+    auto time = clock_diff(start);
+
+    auto& ent = profile_start(name + "!", kind);
+    ent.tokens_in += tokens_in;
+    ent.time_expand += time;
+    if( rv )
+    {
+        rv.reset( new ProfiledTokenStream(mv$(rv), ent) );
+    }
+    return rv;
+}
 ::std::unique_ptr<TokenStream> Expand_Macro(const ::AST::Crate& crate, LList<const AST::Module*> modstack, ::AST::Module& mod, ::AST::MacroInvocation& mi)
 {
     return Expand_Macro(crate, modstack, mod,  mi.span(), mi.name(), mi.input_ident(), mi.input_tt());
@@ -624,6 +808,10 @@ void Expand_Expr(::AST::Crate& crate, LList<const AST::Module*> modstack, ::std:
 }
 void Expand_Expr(::AST::Crate& crate, LList<const AST::Module*> modstack, AST::Expr& node)
 {
+    // The parser flags expressions that contain no macros/attributes/sugar, skip walking those
+    if( !node.needs_expand() ) {
+        return ;
+    }
     auto visitor = CExpandExpr(crate, modstack);
     node.visit_nodes(visitor);
     if( visitor.replacement ) {
@@ -978,6 +1166,10 @@ void Expand_Mod_IndexAnon(::AST::Crate& crate, ::AST::Module& mod)
         }
     }
 }
+void Expand_PrintStats(::std::ostream& os)
+{
+    Macro_InvokeRules_PrintStats(os);
+}
 void Expand(::AST::Crate& crate)
 {
     auto modstack = LList<const ::AST::Module*>(nullptr, &crate.m_root_module);
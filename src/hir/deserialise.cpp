@@ -219,6 +219,7 @@ namespace {
             rv.m_source_crate = m_in.read_string();
             if(rv.m_source_crate == "")
                 rv.m_source_crate = m_crate_name;
+            rv.build_matcher();
             return rv;
         }
         ::MacroPatEnt deserialise_macropatent() {
@@ -9,6 +9,7 @@
  */
 #include "hir.hpp"
 #include <algorithm>
+#include <mutex>
 #include <hir_typeck/common.hpp>
 
 namespace HIR {
@@ -875,18 +876,143 @@ const ::HIR::Function& ::HIR::Crate::get_function_by_path(const Span& sp, const
     }
 }
 
-bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const
+namespace {
+    /// Locks for the lazily-built impl indexes/caches of each crate (sharded by crate address)
+    /// - Entries are never changed once inserted, so only the lookup/insert is done with the lock held.
+    /// - The indexes are only dropped when impls are added, which never overlaps with a lookup on another thread.
+    ::std::mutex    g_impl_index_locks[16];
+    ::std::mutex& impl_index_lock(const ::HIR::Crate& crate)
+    {
+        return g_impl_index_locks[ reinterpret_cast< ::std::uintptr_t>(&crate) / alignof(::HIR::Crate) % 16 ];
+    }
+
+    /// Obtain the head of a type for impl indexing, returns false if the type could match any head
+    /// - Mirrors the top level of `matches_type_int`: impl types of differing heads never match.
+    bool get_type_head(const ::HIR::TypeRef& ty, ::HIR::Crate::TypeHead& out)
+    {
+        unsigned int sub = 0;
+        ::HIR::SimplePath   path;
+        TU_MATCH(::HIR::TypeRef::Data, (ty.m_data), (e),
+        (Infer,
+            return false;
+            ),
+        (Generic,
+            return false;
+            ),
+        (Path,
+            if( e.path.m_data.is_UfcsKnown() )
+                return false;
+            sub = static_cast<unsigned int>(e.path.m_data.tag());
+            if( e.path.m_data.is_Generic() )
+                path = e.path.m_data.as_Generic().m_path;
+            ),
+        (Diverge,
+            ),
+        (Primitive,
+            sub = static_cast<unsigned int>(e);
+            ),
+        (TraitObject,
+            ),
+        (ErasedType,
+            ),
+        (Array,
+            ),
+        (Slice,
+            ),
+        (Tuple,
+            sub = e.size();
+            ),
+        (Borrow,
+            sub = static_cast<unsigned int>(e.type);
+            ),
+        (Pointer,
+            sub = static_cast<unsigned int>(e.type);
+            ),
+        (Function,
+            ),
+        (Closure,
+            )
+        )
+        out = ::HIR::Crate::TypeHead( static_cast<unsigned int>(ty.m_data.tag()), sub, mv$(path) );
+        return true;
+    }
+}
+
+void ::HIR::Crate::ImplHeadIndex::add(unsigned int pos, const ::HIR::TypeRef& impl_type)
 {
-    auto its = this->m_trait_impls.equal_range( trait );
-    for( auto it = its.first; it != its.second; ++ it )
+    TypeHead    head;
+    if( get_type_head(impl_type, head) ) {
+        this->by_head[mv$(head)].push_back( pos );
+    }
+    else {
+        // Generic/UfcsKnown impl types match anything
+        this->blanket.push_back( pos );
+    }
+}
+bool ::HIR::Crate::ImplHeadIndex::visit_candidates(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, unsigned int count, ::std::function<bool(unsigned int)> cb) const
+{
+    const auto& res_ty = (type.m_data.is_Infer() || type.m_data.is_Generic() ? ty_res(type) : type);
+    TypeHead    head;
+    if( !get_type_head(res_ty, head) && !res_ty.m_data.is_Generic() )
     {
-        const auto& impl = it->second;
-        if( impl.matches_type(type, ty_res) ) {
-            if( callback(impl) ) {
+        for(unsigned int pos = 0; pos < count; pos ++)
+        {
+            if( cb(pos) )
                 return true;
-            }
         }
+        return false;
+    }
+
+    // NOTE: A generic can only match blanket impls (`head` is left empty)
+    static const ::std::vector<unsigned int>    empty;
+    auto head_it = (res_ty.m_data.is_Generic() ? this->by_head.end() : this->by_head.find(head));
+    const auto& matching = (head_it != this->by_head.end() ? head_it->second : empty);
+    auto it_h = matching.begin();
+    auto it_b = this->blanket.begin();
+    while( it_h != matching.end() || it_b != this->blanket.end() )
+    {
+        unsigned int pos;
+        if( it_b == this->blanket.end() || (it_h != matching.end() && *it_h < *it_b) )
+            pos = *it_h++;
+        else
+            pos = *it_b++;
+        if( cb(pos) )
+            return true;
+    }
+    return false;
+}
+
+const ::HIR::Crate::TraitImplIndex& ::HIR::Crate::get_trait_impl_index(const ::HIR::SimplePath& trait) const
+{
+    ::std::lock_guard< ::std::mutex>    lh { impl_index_lock(*this) };
+    if( m_trait_impl_index_count != m_trait_impls.size() ) {
+        m_trait_impl_index.clear();
+        m_trait_impl_index_count = m_trait_impls.size();
     }
+    auto it = m_trait_impl_index.find(trait);
+    if( it != m_trait_impl_index.end() )
+        return it->second;
+
+    TraitImplIndex  index;
+    auto its = this->m_trait_impls.equal_range( trait );
+    for( auto it = its.first; it != its.second; ++ it )
+    {
+        index.heads.add( index.impls.size(), it->second.m_type );
+        index.impls.push_back( &it->second );
+    }
+    return m_trait_impl_index.insert( ::std::make_pair(trait, mv$(index)) ).first->second;
+}
+
+bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const
+{
+    // Narrow the search to impls for the same type head (plus blanket impls), visited in the original order
+    const auto& index = this->get_trait_impl_index(trait);
+    bool rv = index.heads.visit_candidates(type, ty_res, index.impls.size(), [&](unsigned int pos) {
+        const auto& impl = *index.impls[pos];
+        return impl.matches_type(type, ty_res) && callback(impl);
+        });
+    if( rv )
+        return true;
     for( const auto& ec : this->m_ext_crates )
     {
         if( ec.second.m_data->find_trait_impls(trait, type, ty_res, callback) ) {
@@ -915,21 +1041,82 @@ bool ::HIR::Crate::find_auto_trait_impls(const ::HIR::SimplePath& trait, const :
     }
     return false;
 }
+const ::HIR::Crate::ImplHeadIndex& ::HIR::Crate::get_type_impl_index() const
+{
+    ::std::lock_guard< ::std::mutex>    lh { impl_index_lock(*this) };
+    if( m_type_impl_index_count != m_type_impls.size() ) {
+        m_type_impl_index = ImplHeadIndex();
+        m_type_impl_method_cache.clear();
+        for(unsigned int pos = 0; pos < m_type_impls.size(); pos ++)
+            m_type_impl_index.add(pos, m_type_impls[pos].m_type);
+        m_type_impl_index_count = m_type_impls.size();
+    }
+    return m_type_impl_index;
+}
 bool ::HIR::Crate::find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback) const
 {
-    // TODO: Restrict which crate is searched based on the type.
-    for( const auto& impl : this->m_type_impls )
+    bool rv = this->get_type_impl_index().visit_candidates(type, ty_res, m_type_impls.size(), [&](unsigned int pos) {
+        const auto& impl = m_type_impls[pos];
+        return impl.matches_type(type, ty_res) && callback(impl);
+        });
+    if( rv )
+        return true;
+    for( const auto& ec : this->m_ext_crates )
     {
-        if( impl.matches_type(type, ty_res) ) {
-            if( callback(impl) ) {
+        //DEBUG("- " << ec.first);
+        if( ec.second.m_data->find_type_impls(type, ty_res, callback) ) {
+            return true;
+        }
+    }
+    return false;
+}
+bool ::HIR::Crate::find_type_impl_methods(const ::HIR::TypeRef& type, const ::std::string& name, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&, const ::HIR::Function&)> callback) const
+{
+    const auto& index = this->get_type_impl_index();
+    auto check_impl = [&](const ::HIR::TypeImpl& impl, const ::HIR::Function& fcn) {
+        return impl.matches_type(type, ty_res) && callback(impl, fcn);
+        };
+
+    const auto& res_ty = (type.m_data.is_Infer() ? ty_res(type) : type);
+    TypeHead    head;
+    if( !res_ty.m_data.is_Generic() && get_type_head(res_ty, head) )
+    {
+        // The impls (for this head) that have the method are cached, so repeated lookups only need `matches_type`
+        auto key = ::std::make_pair(mv$(head), name);
+        ::std::unique_lock< ::std::mutex>   lh { impl_index_lock(*this) };
+        auto it = m_type_impl_method_cache.find(key);
+        if( it == m_type_impl_method_cache.end() )
+        {
+            ::std::vector< ::std::pair<const ::HIR::TypeImpl*, const ::HIR::Function*> >   cands;
+            index.visit_candidates(res_ty, ty_res, m_type_impls.size(), [&](unsigned int pos) {
+                const auto& impl = m_type_impls[pos];
+                auto it = impl.m_methods.find(name);
+                if( it != impl.m_methods.end() )
+                    cands.push_back( ::std::make_pair(&impl, &it->second.data) );
+                return false;
+                });
+            it = m_type_impl_method_cache.insert( ::std::make_pair(mv$(key), mv$(cands)) ).first;
+        }
+        lh.unlock();
+        for(const auto& c : it->second)
+        {
+            if( check_impl(*c.first, *c.second) )
                 return true;
-            }
         }
     }
+    else
+    {
+        bool rv = index.visit_candidates(type, ty_res, m_type_impls.size(), [&](unsigned int pos) {
+            const auto& impl = m_type_impls[pos];
+            auto it = impl.m_methods.find(name);
+            return it != impl.m_methods.end() && check_impl(impl, it->second.data);
+            });
+        if( rv )
+            return true;
+    }
     for( const auto& ec : this->m_ext_crates )
     {
-        //DEBUG("- " << ec.first);
-        if( ec.second.m_data->find_type_impls(type, ty_res, callback) ) {
+        if( ec.second.m_data->find_type_impl_methods(type, name, ty_res, callback) ) {
             return true;
         }
     }
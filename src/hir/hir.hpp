@@ -13,6 +13,7 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <tuple>
 
 #include <tagged_union.hpp>
 
@@ -430,6 +431,37 @@ public:
     ::std::multimap< ::HIR::SimplePath, ::HIR::TraitImpl > m_trait_impls;
     ::std::multimap< ::HIR::SimplePath, ::HIR::MarkerImpl > m_marker_impls;
 
+    /// Simplified form of a type's outermost constructor (data tag, sub-kind, path)
+    typedef ::std::tuple<unsigned int, unsigned int, ::HIR::SimplePath>  TypeHead;
+    /// Index of a list of impls by the head of the impl type
+    struct ImplHeadIndex
+    {
+        /// Positions of impls with a known type head
+        ::std::map< TypeHead, ::std::vector<unsigned int> >  by_head;
+        /// Positions of impls that could match any type (generic or unexpanded associated type)
+        ::std::vector<unsigned int> blanket;
+
+        void add(unsigned int pos, const ::HIR::TypeRef& impl_type);
+        /// Visit (in their original order) the positions of impls that could match `type`
+        /// - `count` is the total number of impls, all are visited if the head of `type` isn't known
+        bool visit_candidates(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, unsigned int count, ::std::function<bool(unsigned int)> cb) const;
+    };
+    /// Per-trait index of `m_trait_impls` by the head of the impl type (built on demand by `find_trait_impls`)
+    struct TraitImplIndex
+    {
+        /// All impls of the trait, in `m_trait_impls` order
+        ::std::vector<const ::HIR::TraitImpl*>  impls;
+        ImplHeadIndex   heads;
+    };
+    mutable ::std::map< ::HIR::SimplePath, TraitImplIndex>  m_trait_impl_index;
+    /// Size of `m_trait_impls` when `m_trait_impl_index` was populated (the index is dropped if impls are added)
+    mutable size_t  m_trait_impl_index_count = 0;
+    /// Index of `m_type_impls` (built on demand by `find_type_impls`)
+    mutable ImplHeadIndex   m_type_impl_index;
+    mutable size_t  m_type_impl_index_count = 0;
+    /// Inherent impls with a method of a given name, for a type head (built on demand by `find_type_impl_methods`)
+    mutable ::std::map< ::std::pair<TypeHead, ::std::string>, ::std::vector<::std::pair<const ::HIR::TypeImpl*, const ::HIR::Function*>> >  m_type_impl_method_cache;
+
     /// Macros exported by this crate
     ::std::unordered_map< ::std::string, ::MacroRulesPtr >  m_exported_macros;
 
@@ -475,8 +507,15 @@ public:
     }
 
     bool find_trait_impls(const ::HIR::SimplePath& path, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TraitImpl&)> callback) const;
+private:
+    const TraitImplIndex& get_trait_impl_index(const ::HIR::SimplePath& trait) const;
+public:
     bool find_auto_trait_impls(const ::HIR::SimplePath& path, const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::MarkerImpl&)> callback) const;
     bool find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback) const;
+    /// Find inherent impls for `type` that define a method called `name`
+    bool find_type_impl_methods(const ::HIR::TypeRef& type, const ::std::string& name, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&, const ::HIR::Function&)> callback) const;
+private:
+    const ImplHeadIndex& get_type_impl_index() const;
 };
 
 }   // namespace HIR
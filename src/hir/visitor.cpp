@@ -7,25 +7,106 @@
  */
 #include <hir/hir.hpp>
 #include <hir/visitor.hpp>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+struct HIR::Visitor::ItemShare
+{
+    ::std::atomic<unsigned int> next_item;
+    ::std::atomic<bool> failed;
+};
 
 ::HIR::Visitor::~Visitor()
 {
 }
 
+void ::HIR::Visitor::visit_crate_parallel(::HIR::Crate& crate, const ::std::vector<Visitor*>& visitors)
+{
+    assert( !visitors.empty() );
+    if( visitors.size() == 1 )
+    {
+        visitors[0]->visit_crate(crate);
+        return ;
+    }
+
+    ItemShare   share;
+    share.next_item = 0;
+    share.failed = false;
+    ::std::mutex    lock;
+    ::std::exception_ptr    error;
+    const auto phase = debug_get_phase();
+
+    auto worker = [&](Visitor& v) {
+        debug_set_phase(phase);
+        v.m_item_share = &share;
+        v.m_item_share_claim = true;
+        try
+        {
+            v.visit_crate(crate);
+        }
+        catch(...)
+        {
+            ::std::lock_guard< ::std::mutex>    lh(lock);
+            if( !error )
+                error = ::std::current_exception();
+            share.failed = true;
+        }
+        v.m_item_share = nullptr;
+    };
+
+    ::std::vector< ::std::thread>   threads;
+    for(size_t i = 1; i < visitors.size(); i ++)
+        threads.push_back( ::std::thread(worker, ::std::ref(*visitors[i])) );
+    worker(*visitors[0]);
+    for(auto& t : threads)
+        t.join();
+
+    if( error )
+        ::std::rethrow_exception(error);
+}
+
+bool ::HIR::Visitor::claim_item()
+{
+    auto idx = m_item_index_next ++;
+    if( m_item_share )
+    {
+        // Every visitor encounters the items in the same order, so the shared counter hands each index to exactly one
+        // of them. The next index is only claimed once the previous one has been visited (to balance the load).
+        if( m_item_share_claim )
+        {
+            m_item_claimed = (m_item_share->failed ? ~0u : m_item_share->next_item ++);
+            m_item_share_claim = false;
+        }
+        if( idx != m_item_claimed )
+            return false;
+        m_item_share_claim = true;
+    }
+    m_item_index = idx;
+    return true;
+}
+
 void ::HIR::Visitor::visit_crate(::HIR::Crate& crate)
 {
+    m_item_index_next = 0;
     this->visit_module(::HIR::ItemPath(crate.m_crate_name), crate.m_root_module );
 
     for( auto& ty_impl : crate.m_type_impls )
     {
+        if( !this->claim_item() )
+            continue ;
         this->visit_type_impl(ty_impl);
     }
     for( auto& impl : crate.m_trait_impls )
     {
+        if( !this->claim_item() )
+            continue ;
         this->visit_trait_impl(impl.first, impl.second);
     }
     for( auto& impl : crate.m_marker_impls )
     {
+        if( !this->claim_item() )
+            continue ;
         this->visit_marker_impl(impl.first, impl.second);
     }
 }
@@ -37,6 +118,9 @@ void ::HIR::Visitor::visit_module(::HIR::ItemPath p, ::HIR::Module& mod)
     {
         const auto& name = named.first;
         auto& item = named.second->ent;
+        // Sub-modules are walked by all visitors (only their items are shared out)
+        if( !item.is_Module() && !this->claim_item() )
+            continue ;
         TU_MATCH(::HIR::TypeItem, (item), (e),
         (Import, ),
         (Module,
@@ -69,6 +153,8 @@ void ::HIR::Visitor::visit_module(::HIR::ItemPath p, ::HIR::Module& mod)
     {
         const auto& name = named.first;
         auto& item = named.second->ent;
+        if( !this->claim_item() )
+            continue ;
         TU_MATCH(::HIR::ValueItem, (item), (e),
         (Import,
             // SimplePath - no visitor
@@ -18,9 +18,23 @@ namespace HIR {
 // TODO: Split into Visitor and ItemVisitor
 class Visitor
 {
+    /// Shared state for `visit_crate_parallel`
+    struct ItemShare;
+    ItemShare*  m_item_share = nullptr;
+    bool    m_item_share_claim = true;
+    unsigned int    m_item_claimed = 0;
+    /// Index (in serial visit order) of the next item encountered, and of the item currently being visited
+    unsigned int    m_item_index_next = 0;
+    unsigned int    m_item_index = 0;
 public:
     virtual ~Visitor();
 
+    /// Visit the crate using several visitors at once, the calling thread runs the first and each other gets its own thread.
+    ///
+    /// Every visitor walks every module, but each item and impl block is handed to exactly one visitor. Visitors must
+    /// therefore only modify the item they are visiting. The first exception raised by a visitor is re-thrown.
+    static void visit_crate_parallel(::HIR::Crate& crate, const ::std::vector<Visitor*>& visitors);
+
     virtual void visit_crate(::HIR::Crate& crate);
 
     virtual void visit_module(ItemPath p, ::HIR::Module& mod);
@@ -58,7 +72,32 @@ public:
     virtual void visit_generic_path(::HIR::GenericPath& p, PathContext );
 
     virtual void visit_expr(::HIR::ExprPtr& exp);
+
+protected:
+    /// Called before visiting each item/impl, returns false if another visitor is handling it (see `visit_crate_parallel`)
+    bool claim_item();
+    /// Index of the item/impl being visited, in the order a serial `visit_crate` would visit them
+    unsigned int cur_item_index() const { return m_item_index; }
 };
 
+/// Construct `num_threads` visitors of type `V` (from `args`), and use them to visit the crate in parallel
+///
+/// Returns the visitors, so any results they collected can be merged (in a deterministic order) by the caller
+template<typename V, typename... Args>
+::std::vector<V> visit_crate_parallel(::HIR::Crate& crate, unsigned int num_threads, Args&&... args)
+{
+    ::std::vector<V>    visitors;
+    visitors.reserve(num_threads > 1 ? num_threads : 1);
+    do {
+        visitors.push_back( V(args...) );
+    } while( visitors.size() < num_threads );
+
+    ::std::vector<Visitor*> visitor_ptrs;
+    for(auto& v : visitors)
+        visitor_ptrs.push_back(&v);
+    Visitor::visit_crate_parallel(crate, visitor_ptrs);
+    return visitors;
+}
+
 }   // namespace HIR
 
@@ -641,8 +641,15 @@ namespace {
     };
 }
 
-void HIR_Expand_AnnotateUsage(::HIR::Crate& crate)
+void HIR_Expand_AnnotateUsage(::HIR::Crate& crate, unsigned int num_threads)
 {
-    OuterVisitor    ov(crate);
-    ov.visit_crate( crate );
+    ::HIR::visit_crate_parallel<OuterVisitor>(crate, num_threads, crate);
+}
+void HIR_Expand_AnnotateUsage_Expr(const StaticTraitResolve& resolve, ::HIR::ExprPtr& exp)
+{
+    if( exp )
+    {
+        ExprVisitor_Mark    ev { resolve };
+        ev.visit_root( exp );
+    }
 }
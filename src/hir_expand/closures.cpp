@@ -9,6 +9,7 @@
 #include <hir/expr.hpp>
 #include <hir_typeck/static.hpp>
 #include <algorithm>
+#include <mutex>
 #include "main_bindings.hpp"
 
 namespace {
@@ -21,6 +22,52 @@ namespace {
     typedef ::std::function< ::HIR::SimplePath(::HIR::Struct )>   new_type_cb_t;
     typedef ::std::vector< ::std::pair< ::HIR::ExprNode_Closure::Class, ::HIR::TraitImpl> > out_impls_t;
 
+    /// Closure structs created by the pass
+    ///
+    /// These are only added to the crate once every item has been visited (so modules don't change while other threads
+    /// are walking them), and are then added in the order that a serial visit would have created them.
+    class NewClosureStructs
+    {
+        struct Ent
+        {
+            unsigned int    item_index;
+            ::HIR::Module*  mod;
+            ::std::string   name;
+            ::std::unique_ptr< ::HIR::VisEnt< ::HIR::TypeItem> >    item;
+        };
+        mutable ::std::mutex    m_lock;
+        ::std::vector<Ent>  m_ents;
+        ::std::map< ::HIR::SimplePath, const ::HIR::Struct*>    m_by_path;
+    public:
+        void add(unsigned int item_index, ::HIR::Module& mod, ::std::string name, ::HIR::SimplePath path, ::HIR::Struct str)
+        {
+            auto boxed = box$( (::HIR::VisEnt< ::HIR::TypeItem> { false, ::HIR::TypeItem( mv$(str) ) }) );
+            const auto* str_ptr = &boxed->ent.as_Struct();
+
+            ::std::lock_guard< ::std::mutex>    lh(m_lock);
+            m_ents.push_back( Ent { item_index, &mod, mv$(name), mv$(boxed) } );
+            m_by_path.insert( ::std::make_pair(mv$(path), str_ptr) );
+        }
+        const ::HIR::Struct& get(const Span& sp, const ::HIR::SimplePath& path) const
+        {
+            ::std::lock_guard< ::std::mutex>    lh(m_lock);
+            auto it = m_by_path.find(path);
+            ASSERT_BUG(sp, it != m_by_path.end(), "Closure struct " << path << " not found");
+            return *it->second;
+        }
+        void insert_into_crate()
+        {
+            // Entries for the same item are always added by the same thread, so a stable sort keeps them in order
+            ::std::stable_sort(m_ents.begin(), m_ents.end(), [](const Ent& a, const Ent& b){ return a.item_index < b.item_index; });
+            for(auto& ent : m_ents)
+            {
+                ent.mod->m_mod_items.insert( ::std::make_pair(mv$(ent.name), mv$(ent.item)) );
+            }
+            m_ents.clear();
+            m_by_path.clear();
+        }
+    };
+
     template<typename K, typename V>
     ::std::map<K,V> make_map1(K k1, V v1) {
         ::std::map<K,V> rv;
@@ -192,20 +239,20 @@ namespace {
     class ExprVisitor_Fixup:
         public ::HIR::ExprVisitorDef
     {
-        const ::HIR::Crate& m_crate;
+        const NewClosureStructs&    m_new_structs;
         t_cb_generic    m_monomorph_cb;
     public:
-        ExprVisitor_Fixup(const ::HIR::Crate& crate, t_cb_generic monomorph_cb):
-            m_crate(crate),
+        ExprVisitor_Fixup(const NewClosureStructs& new_structs, t_cb_generic monomorph_cb):
+            m_new_structs(new_structs),
             m_monomorph_cb( mv$(monomorph_cb) )
         {
         }
 
-        static void fix_type(const ::HIR::Crate& crate, t_cb_generic monomorph_cb, ::HIR::TypeRef& ty) {
+        static void fix_type(const NewClosureStructs& new_structs, t_cb_generic monomorph_cb, ::HIR::TypeRef& ty) {
             TU_IFLET( ::HIR::TypeRef::Data, ty.m_data, Closure, e,
                 DEBUG("Closure: " << e.node->m_obj_path_base);
                 auto path = monomorphise_genericpath_with(Span(), e.node->m_obj_path_base, monomorph_cb, false);
-                const auto& str = crate.get_struct_by_path( Span(), path.m_path );
+                const auto& str = new_structs.get( Span(), path.m_path );
                 DEBUG(ty << " -> " << path);
                 ty = ::HIR::TypeRef::new_path( mv$(path), ::HIR::TypeRef::TypePathBinding::make_Struct(&str) );
             )
@@ -257,7 +304,7 @@ namespace {
 
         void visit_type(::HIR::TypeRef& ty) override
         {
-            fix_type(m_crate, m_monomorph_cb, ty);
+            fix_type(m_new_structs, m_monomorph_cb, ty);
             ::HIR::ExprVisitorDef::visit_type(ty);
         }
     };
@@ -419,17 +466,19 @@ namespace {
         // Outputs
         out_impls_t&    m_out_impls;
         const new_type_cb_t&    m_new_type;
+        const NewClosureStructs&    m_new_structs;
 
         /// Stack of active closures
         ::std::vector<ClosureScope> m_closure_stack;
 
     public:
-        ExprVisitor_Extract(const StaticTraitResolve& resolve, const ::HIR::TypeRef* self_type, ::std::vector< ::HIR::TypeRef>& var_types, out_impls_t& out_impls, const new_type_cb_t& new_type):
+        ExprVisitor_Extract(const StaticTraitResolve& resolve, const ::HIR::TypeRef* self_type, ::std::vector< ::HIR::TypeRef>& var_types, out_impls_t& out_impls, const new_type_cb_t& new_type, const NewClosureStructs& new_structs):
             m_resolve(resolve),
             m_self_type(self_type),
             m_variable_types(var_types),
             m_out_impls( out_impls ),
-            m_new_type( new_type )
+            m_new_type( new_type ),
+            m_new_structs( new_structs )
         {
         }
 
@@ -626,7 +675,7 @@ namespace {
                 }
 
                 // - Fix type to replace closure types with known paths
-                ExprVisitor_Fixup   fixup { m_resolve.m_crate, monomorph_cb };
+                ExprVisitor_Fixup   fixup { m_new_structs, monomorph_cb };
                 fixup.visit_type(ty_mono);
                 capture_types.push_back( ::HIR::VisEnt< ::HIR::TypeRef> { false, mv$(ty_mono) } );
             }
@@ -637,7 +686,7 @@ namespace {
                     ::HIR::Struct::Data::make_Tuple(mv$(capture_types))
                     }
                 );
-            const auto& closure_struct_ref = m_resolve.m_crate.get_struct_by_path(sp, closure_struct_path);
+            const auto& closure_struct_ref = m_new_structs.get(sp, closure_struct_path);
 
             // Mark the object pathname in the closure.
             node.m_obj_path = ::HIR::GenericPath( closure_struct_path, mv$(constructor_path_params) );
@@ -668,7 +717,7 @@ namespace {
 
             {
                 DEBUG("-- Fixing types in body code");
-                ExprVisitor_Fixup   fixup { m_resolve.m_crate, monomorph_cb };
+                ExprVisitor_Fixup   fixup { m_new_structs, monomorph_cb };
                 fixup.visit_root( body_code );
 
                 DEBUG("-- Fixing types in signature");
@@ -988,47 +1037,97 @@ namespace {
         }
     };
 
+    /// Counts the closures in each function, so the closures can be numbered in serial visit order
+    class OuterVisitor_Count:
+        public ::HIR::Visitor
+    {
+        class ExprVisitor_Count:
+            public ::HIR::ExprVisitorDef
+        {
+        public:
+            unsigned int    count = 0;
+            void visit(::HIR::ExprNode_Closure& node) override {
+                count ++;
+                ::HIR::ExprVisitorDef::visit(node);
+            }
+        };
+        /// Module that closures are being added to (nullptr for impl blocks, which add to the crate root)
+        const ::HIR::Module*    m_cur_mod = nullptr;
+    public:
+        struct Ent {
+            unsigned int    item_index;
+            const ::HIR::Module*    mod;
+            const ::HIR::Function*  fcn;
+            unsigned int    count;
+        };
+        ::std::vector<Ent>  m_counts;
+
+        OuterVisitor_Count(const ::HIR::Crate& crate)
+        {}
+
+        void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
+        {
+            auto saved = m_cur_mod;
+            m_cur_mod = &mod;
+            ::HIR::Visitor::visit_module(p, mod);
+            m_cur_mod = saved;
+        }
+        void visit_function(::HIR::ItemPath p, ::HIR::Function& item) override {
+            if( item.m_code )
+            {
+                ExprVisitor_Count   ev;
+                item.m_code->visit(ev);
+                if( ev.count > 0 )
+                    m_counts.push_back( Ent { this->cur_item_index(), m_cur_mod, &item, ev.count } );
+            }
+        }
+    };
+
     class OuterVisitor:
         public ::HIR::Visitor
     {
+    protected:
         StaticTraitResolve  m_resolve;
-        out_impls_t m_new_trait_impls;
+    private:
+        const ::std::map<const ::HIR::Function*, unsigned int>&  m_closure_bases;
+        NewClosureStructs&  m_new_structs;
+        /// Number of the next closure struct to be created (within the current module, or the crate root for impls)
+        unsigned int    m_closure_index = 0;
         new_type_cb_t   m_new_type;
         const ::HIR::SimplePath*  m_cur_mod_path;
         const ::HIR::TypeRef*   m_self_type = nullptr;
     public:
-        OuterVisitor(const ::HIR::Crate& crate):
+        /// Trait impls for the closures, along with the index of the item they came from
+        ::std::vector< ::std::pair<unsigned int, out_impls_t> > m_new_trait_impls;
+
+        OuterVisitor(const ::HIR::Crate& crate, const ::std::map<const ::HIR::Function*, unsigned int>& closure_bases, NewClosureStructs& new_structs):
             m_resolve(crate),
+            m_closure_bases(closure_bases),
+            m_new_structs(new_structs),
             m_cur_mod_path( nullptr )
         {}
 
+    protected:
+        /// Called on a function body (with the function's generics set) before closures are extracted
+        virtual void before_closures(::HIR::ExprPtr& code) {}
+        /// Called on a function body after closures have been extracted, along with the trait impls for those closures
+        virtual void after_closures(::HIR::ExprPtr& code, out_impls_t& new_impls) {}
+
+    public:
+
         void visit_crate(::HIR::Crate& crate) override
         {
-            Span    sp;
-
-            unsigned int closure_count = 0;
             ::HIR::SimplePath   root_mod_path(crate.m_crate_name,{});
             m_cur_mod_path = &root_mod_path;
             m_new_type = [&](auto s)->auto {
-                auto name = FMT("closure_I_" << closure_count);
-                closure_count += 1;
-                auto boxed = box$(( ::HIR::VisEnt< ::HIR::TypeItem> { false, ::HIR::TypeItem( mv$(s) ) } ));
-                crate.m_root_module.m_mod_items.insert( ::std::make_pair(name, mv$(boxed)) );
-                return ::HIR::SimplePath(crate.m_crate_name, {}) + name;
+                auto name = FMT("closure_I_" << m_closure_index);
+                m_closure_index += 1;
+                auto path = ::HIR::SimplePath(crate.m_crate_name, {}) + name;
+                m_new_structs.add(this->cur_item_index(), crate.m_root_module, mv$(name), path.clone(), mv$(s));
+                return path;
                 };
 
             ::HIR::Visitor::visit_crate(crate);
-
-            for(auto& impl : m_new_trait_impls)
-            {
-                const auto& trait =
-                    impl.first == ::HIR::ExprNode_Closure::Class::Once ? crate.get_lang_item_path(sp, "fn_once")
-                    : impl.first == ::HIR::ExprNode_Closure::Class::Mut ? crate.get_lang_item_path(sp, "fn_mut")
-                    : /*impl.first == ::HIR::ExprNode_Closure::Class::Shared ?*/ crate.get_lang_item_path(sp, "fn")
-                    ;
-                crate.m_trait_impls.insert( ::std::make_pair(trait.clone(), mv$(impl.second)) );
-            }
-            m_new_trait_impls.resize(0);
         }
 
         void visit_module(::HIR::ItemPath p, ::HIR::Module& mod) override
@@ -1037,14 +1136,13 @@ namespace {
             auto path = p.get_simple_path();
             m_cur_mod_path = &path;
 
-            unsigned int closure_count = 0;
             auto saved_nt = mv$(m_new_type);
             m_new_type = [&](auto s)->auto {
-                auto name = FMT("closure_" << closure_count);
-                closure_count += 1;
-                auto boxed = box$( (::HIR::VisEnt< ::HIR::TypeItem> { false, ::HIR::TypeItem( mv$(s) ) }) );
-                mod.m_mod_items.insert( ::std::make_pair(name, mv$(boxed)) );
-                return (p + name).get_simple_path();
+                auto name = FMT("closure_" << m_closure_index);
+                m_closure_index += 1;
+                auto item_path = (p + name).get_simple_path();
+                m_new_structs.add(this->cur_item_index(), mod, mv$(name), item_path.clone(), mv$(s));
+                return item_path;
                 };
 
             ::HIR::Visitor::visit_module(p, mod);
@@ -1084,15 +1182,27 @@ namespace {
                 assert( m_cur_mod_path );
                 DEBUG("Function code " << p);
 
+                this->before_closures(item.m_code);
+
+                auto it = m_closure_bases.find(&item);
+                if( it != m_closure_bases.end() )
+                {
+                    m_closure_index = it->second;
+                }
+                out_impls_t new_impls;
                 {
-                    ExprVisitor_Extract    ev(m_resolve, m_self_type, item.m_code.m_bindings, m_new_trait_impls, m_new_type);
+                    ExprVisitor_Extract    ev(m_resolve, m_self_type, item.m_code.m_bindings, new_impls, m_new_type, m_new_structs);
                     ev.visit_root( *item.m_code );
                 }
 
                 {
-                    ExprVisitor_Fixup   fixup(m_resolve.m_crate, [](const auto& x)->const auto&{ return x; });
+                    ExprVisitor_Fixup   fixup(m_new_structs, [](const auto& x)->const auto&{ return x; });
                     fixup.visit_root( item.m_code );
                 }
+
+                this->after_closures(item.m_code, new_impls);
+                if( !new_impls.empty() )
+                    m_new_trait_impls.push_back( ::std::make_pair(this->cur_item_index(), mv$(new_impls)) );
             }
             else
             {
@@ -1161,11 +1271,135 @@ namespace {
             m_self_type = nullptr;
         }
     };
+
+    /// Closure extraction combined with the other per-body expansion passes (see `HIR_Expand_Fused`)
+    ///
+    /// Each body is annotated before its closures are extracted, then has calls and reborrows expanded (along with the
+    /// bodies of the new closure impls). This matches the order the separate passes would be applied to that body.
+    class OuterVisitor_Fused:
+        public OuterVisitor
+    {
+        const ::HIR::Crate& m_crate;
+    public:
+        OuterVisitor_Fused(const ::HIR::Crate& crate, const ::std::map<const ::HIR::Function*, unsigned int>& closure_bases, NewClosureStructs& new_structs):
+            OuterVisitor(crate, closure_bases, new_structs),
+            m_crate(crate)
+        {}
+
+    private:
+        void expand_body(::HIR::ExprPtr& exp)
+        {
+            HIR_Expand_AnnotateUsage_Expr(m_resolve, exp);
+            HIR_Expand_UfcsEverything_Expr(m_crate, exp);
+            HIR_Expand_Reborrows_Expr(m_crate, exp);
+        }
+    protected:
+        void before_closures(::HIR::ExprPtr& code) override
+        {
+            HIR_Expand_AnnotateUsage_Expr(m_resolve, code);
+        }
+        void after_closures(::HIR::ExprPtr& code, out_impls_t& new_impls) override
+        {
+            HIR_Expand_UfcsEverything_Expr(m_crate, code);
+            HIR_Expand_Reborrows_Expr(m_crate, code);
+            // NOTE: Closure bodies were annotated as part of the parent body
+            for(auto& impl : new_impls)
+            {
+                for(auto& m : impl.second.m_methods)
+                {
+                    HIR_Expand_UfcsEverything_Expr(m_crate, m.second.data.m_code);
+                    HIR_Expand_Reborrows_Expr(m_crate, m.second.data.m_code);
+                }
+            }
+        }
+
+    public:
+        void visit_type(::HIR::TypeRef& ty) override
+        {
+            TU_IFLET(::HIR::TypeRef::Data, ty.m_data, Array, e,
+                this->visit_type( *e.inner );
+                if( e.size ) {
+                    expand_body(*e.size);
+                }
+            )
+            else {
+                OuterVisitor::visit_type(ty);
+            }
+        }
+        void visit_static(::HIR::ItemPath p, ::HIR::Static& item) override {
+            expand_body(item.m_value);
+        }
+        void visit_constant(::HIR::ItemPath p, ::HIR::Constant& item) override {
+            expand_body(item.m_value);
+        }
+        void visit_enum(::HIR::ItemPath p, ::HIR::Enum& item) override {
+            auto _ = this->m_resolve.set_item_generics(item.m_params);
+            for(auto& var : item.m_variants)
+            {
+                TU_IFLET(::HIR::Enum::Variant, var.second, Value, e,
+                    DEBUG("Enum value " << p << " - " << var.first);
+                    expand_body(e.expr);
+                )
+            }
+        }
+    };
+
+    /// Run closure extraction over the crate using visitors of type `V`, then add the new closure types and impls
+    template<typename V>
+    void expand_closures(::HIR::Crate& crate, unsigned int num_threads)
+    {
+        Span    sp;
+
+        // Closure structs are numbered in the order a serial visit would create them, so pre-count the closures in
+        // each function and give each function its starting index.
+        ::std::map<const ::HIR::Function*, unsigned int>    closure_bases;
+        {
+            ::std::vector<OuterVisitor_Count::Ent>  counts;
+            for(auto& v : ::HIR::visit_crate_parallel<OuterVisitor_Count>(crate, num_threads, crate))
+                counts.insert(counts.end(), v.m_counts.begin(), v.m_counts.end());
+            ::std::stable_sort(counts.begin(), counts.end(), [](const auto& a, const auto& b){ return a.item_index < b.item_index; });
+
+            ::std::map<const ::HIR::Module*, unsigned int>  next_index;
+            for(const auto& ent : counts)
+            {
+                auto& idx = next_index[ent.mod];
+                closure_bases.insert( ::std::make_pair(ent.fcn, idx) );
+                idx += ent.count;
+            }
+        }
+
+        NewClosureStructs   new_structs;
+        auto visitors = ::HIR::visit_crate_parallel<V>(crate, num_threads, crate, closure_bases, new_structs);
+
+        new_structs.insert_into_crate();
+
+        ::std::vector< ::std::pair<unsigned int, out_impls_t> > new_trait_impls;
+        for(auto& v : visitors)
+        {
+            for(auto& ent : v.m_new_trait_impls)
+                new_trait_impls.push_back( mv$(ent) );
+        }
+        ::std::stable_sort(new_trait_impls.begin(), new_trait_impls.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+        for(auto& ent : new_trait_impls)
+        {
+            for(auto& impl : ent.second)
+            {
+                const auto& trait =
+                    impl.first == ::HIR::ExprNode_Closure::Class::Once ? crate.get_lang_item_path(sp, "fn_once")
+                    : impl.first == ::HIR::ExprNode_Closure::Class::Mut ? crate.get_lang_item_path(sp, "fn_mut")
+                    : /*impl.first == ::HIR::ExprNode_Closure::Class::Shared ?*/ crate.get_lang_item_path(sp, "fn")
+                    ;
+                crate.m_trait_impls.insert( ::std::make_pair(trait.clone(), mv$(impl.second)) );
+            }
+        }
+    }
 }
 
-void HIR_Expand_Closures(::HIR::Crate& crate)
+void HIR_Expand_Closures(::HIR::Crate& crate, unsigned int num_threads)
 {
-    OuterVisitor    ov(crate);
-    ov.visit_crate( crate );
+    expand_closures<OuterVisitor>(crate, num_threads);
+}
+void HIR_Expand_Fused(::HIR::Crate& crate, unsigned int num_threads)
+{
+    expand_closures<OuterVisitor_Fused>(crate, num_threads);
 }
-
@@ -9,12 +9,20 @@
 
 namespace HIR {
     class Crate;
+    class ExprPtr;
 };
+class StaticTraitResolve;
 
-extern void HIR_Expand_AnnotateUsage(::HIR::Crate& crate);
+extern void HIR_Expand_AnnotateUsage(::HIR::Crate& crate, unsigned int num_threads);
 extern void HIR_Expand_VTables(::HIR::Crate& crate);
-extern void HIR_Expand_Closures(::HIR::Crate& crate);
-extern void HIR_Expand_UfcsEverything(::HIR::Crate& crate);
-extern void HIR_Expand_Reborrows(::HIR::Crate& crate);
+extern void HIR_Expand_Closures(::HIR::Crate& crate, unsigned int num_threads);
+extern void HIR_Expand_UfcsEverything(::HIR::Crate& crate, unsigned int num_threads);
+extern void HIR_Expand_Reborrows(::HIR::Crate& crate, unsigned int num_threads);
 extern void HIR_Expand_ErasedType(::HIR::Crate& crate);
+/// Annotate, Closures, Calls and Reborrows run as a single traversal (VTables and ErasedType still have to be run after)
+extern void HIR_Expand_Fused(::HIR::Crate& crate, unsigned int num_threads);
+// - Single expression versions (for the fused pipeline), `resolve` must have the body's generics set
+extern void HIR_Expand_AnnotateUsage_Expr(const StaticTraitResolve& resolve, ::HIR::ExprPtr& exp);
+extern void HIR_Expand_UfcsEverything_Expr(const ::HIR::Crate& crate, ::HIR::ExprPtr& exp);
+extern void HIR_Expand_Reborrows_Expr(const ::HIR::Crate& crate, ::HIR::ExprPtr& exp);
 extern void ConvertHIR_ConstantEvaluateFull(::HIR::Crate& crate);
@@ -218,8 +218,15 @@ namespace {
     };
 }   // namespace
 
-void HIR_Expand_Reborrows(::HIR::Crate& crate)
+void HIR_Expand_Reborrows(::HIR::Crate& crate, unsigned int num_threads)
 {
-    OuterVisitor    ov(crate);
-    ov.visit_crate( crate );
+    ::HIR::visit_crate_parallel<OuterVisitor>(crate, num_threads, crate);
+}
+void HIR_Expand_Reborrows_Expr(const ::HIR::Crate& crate, ::HIR::ExprPtr& exp)
+{
+    if( exp )
+    {
+        ExprVisitor_Mutate  ev(crate);
+        ev.visit_node_ptr(exp);
+    }
 }
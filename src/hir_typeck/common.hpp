@@ -10,6 +10,7 @@
 #include "impl_ref.hpp"
 #include <hir/generic_params.hpp>
 #include <hir/type.hpp>
+#include <atomic>
 
 // TODO/NOTE - This is identical to ::HIR::t_cb_resolve_type
 typedef ::std::function<const ::HIR::TypeRef&(const ::HIR::TypeRef&)>   t_cb_generic;
@@ -119,3 +120,12 @@ static inline t_cb_generic monomorphise_type_get_cb(const Span& sp, const ::HIR:
 }
 
 extern void check_type_class_primitive(const Span& sp, const ::HIR::TypeRef& type, ::HIR::InferClass ic, ::HIR::CoreType ct);
+
+/// Counters for the associated type projection caches (reported by `Typecheck_PrintStats`)
+struct ProjectionCacheStats
+{
+    ::std::atomic<unsigned int> hits { 0 };
+    ::std::atomic<unsigned int> misses { 0 };
+};
+extern ProjectionCacheStats g_projection_cache_stats_typeck;
+extern ProjectionCacheStats g_projection_cache_stats_static;
@@ -10,6 +10,7 @@
 #include <hir/hir.hpp>
 #include <hir/visitor.hpp>
 #include <algorithm>    // std::find_if
+#include <ctime>
 
 #include "helpers.hpp"
 #include "expr_visit.hpp"
@@ -36,11 +37,33 @@ struct Context
         //unsigned int ivar;
     };
 
+    /// A call to `possible_equate_type`/`possible_equate_type_disable` made while checking a rule
+    struct PossibleRecord
+    {
+        unsigned int    ivar_index;
+        bool    is_disable;
+        bool    is_to;
+        bool    is_borrow;
+        ::HIR::TypeRef  ty;
+    };
+    /// Result of the last check of a rule that made no progress
+    /// - If none of `ivars` have changed since then (and no rules/nodes were added or rewritten), the check would
+    ///   do exactly the same thing again, so it's skipped and the recorded possibilities are replayed.
+    struct RuleWait
+    {
+        bool    valid = false;
+        unsigned int    generation = 0;
+        unsigned int    epoch = 0;
+        ::std::vector<unsigned int> ivars;
+        ::std::vector<PossibleRecord>   possibles;
+    };
+
     /// Inferrence variable equalities
     struct Coercion
     {
         ::HIR::TypeRef  left_ty;
         ::HIR::ExprNodeP* right_node_ptr;
+        RuleWait    wait;
 
         friend ::std::ostream& operator<<(::std::ostream& os, const Coercion& v) {
             os << v.left_ty << " := " << v.right_node_ptr << " " << &**v.right_node_ptr << " (" << (*v.right_node_ptr)->m_res_type << ")";
@@ -59,6 +82,7 @@ struct Context
 
         // HACK: operators are special - the result when both types are primitives is ALWAYS the lefthand side
         bool    is_operator;
+        RuleWait    wait;
 
         friend ::std::ostream& operator<<(::std::ostream& os, const Associated& v) {
             if( v.name == "" ) {
@@ -105,6 +129,10 @@ struct Context
     ::std::vector< ::std::unique_ptr<Revisitor> >   adv_revisits;
 
     ::std::vector< IVarPossible>    possible_ivar_vals;
+    /// If non-null, possibility calls are also recorded here (see `RuleWait`)
+    ::std::vector<PossibleRecord>*  m_possible_record = nullptr;
+    /// Incremented whenever a revisit is added (rules are covered by `HMTypeInferrence::change_epoch`)
+    unsigned int    m_revisit_count = 0;
 
     const ::HIR::SimplePath m_lang_Box;
 
@@ -116,8 +144,12 @@ struct Context
     }
 
     void dump() const;
+    /// Print the outstanding rules (used when reporting a stalled typecheck)
+    void dump_rules(::std::ostream& os) const;
 
     bool take_changed() { return m_ivars.take_changed(); }
+    /// Changes whenever a rule check could have a different outcome for a reason other than an ivar changing
+    unsigned int rule_epoch() const { return m_ivars.change_epoch() + m_revisit_count; }
     bool has_rules() const {
         return !(link_coerce.empty() && link_assoc.empty() && to_visit.empty() && adv_revisits.empty());
     }
@@ -3158,6 +3190,24 @@ void Context::dump() const {
     DEBUG("---");
 }
 
+void Context::dump_rules(::std::ostream& os) const {
+    os << link_coerce.size() << " Coercions, " << link_assoc.size() << " associated, " << to_visit.size() << " nodes, " << adv_revisits.size() << " callbacks" << ::std::endl;
+    for(const auto& v : link_coerce) {
+        os << "  " << v << ::std::endl;
+    }
+    for(const auto& v : link_assoc) {
+        os << "  " << v << ::std::endl;
+    }
+    for(const auto& v : to_visit) {
+        os << "  " << v->span() << " " << typeid(*v).name() << " -> " << this->m_ivars.fmt_type(v->m_res_type) << ::std::endl;
+    }
+    for(const auto& v : adv_revisits) {
+        os << "  ";
+        v->fmt(os);
+        os << ::std::endl;
+    }
+}
+
 void Context::equate_types(const Span& sp, const ::HIR::TypeRef& li, const ::HIR::TypeRef& ri) {
 
     if( li == ri || this->m_ivars.get_type(li) == this->m_ivars.get_type(ri) ) {
@@ -3978,9 +4028,11 @@ void Context::equate_types_assoc(const Span& sp, const ::HIR::TypeRef& l,  const
 }
 void Context::add_revisit(::HIR::ExprNode& node) {
     this->to_visit.push_back( &node );
+    this->m_revisit_count ++;
 }
 void Context::add_revisit_adv(::std::unique_ptr<Revisitor> ent_ptr) {
     this->adv_revisits.push_back( mv$(ent_ptr) );
+    this->m_revisit_count ++;
 }
 
 void Context::possible_equate_type(unsigned int ivar_index, const ::HIR::TypeRef& t, bool is_to, bool is_borrow) {
@@ -3990,6 +4042,9 @@ void Context::possible_equate_type(unsigned int ivar_index, const ::HIR::TypeRef
         ty_l.m_data.as_Infer().index = ivar_index;
         assert( m_ivars.get_type(ty_l).m_data.is_Infer() );
     }
+    if( m_possible_record ) {
+        m_possible_record->push_back(PossibleRecord { ivar_index, false, is_to, is_borrow, t.clone() });
+    }
 
     if( ivar_index >= possible_ivar_vals.size() ) {
         possible_ivar_vals.resize( ivar_index + 1 );
@@ -4008,6 +4063,9 @@ void Context::possible_equate_type_disable(unsigned int ivar_index, bool is_to)
         ty_l.m_data.as_Infer().index = ivar_index;
         assert( m_ivars.get_type(ty_l).m_data.is_Infer() );
     }
+    if( m_possible_record ) {
+        m_possible_record->push_back(PossibleRecord { ivar_index, true, is_to, false, ::HIR::TypeRef() });
+    }
 
     if( ivar_index >= possible_ivar_vals.size() ) {
         possible_ivar_vals.resize( ivar_index + 1 );
@@ -5763,9 +5821,84 @@ namespace {
 
 
 
+namespace {
+    /// Options and accumulated results for `--typeck-stats` and the slow-function warnings
+    struct SolverStats
+    {
+        struct Func {
+            Span    sp;
+            unsigned int    passes = 0;
+            unsigned int    ivars = 0;
+            unsigned int    coercion_checks = 0;
+            unsigned int    assoc_checks = 0;
+            unsigned int    rule_skips = 0;
+            unsigned int    trait_searches = 0;
+            double  seconds = 0;
+        };
+
+        bool    enabled = false;
+        unsigned int    warn_ms = 0;
+        unsigned int    warn_passes = 0;
+        bool    dump_stalled = false;
+
+        unsigned int    n_functions = 0;
+        Func    totals;
+        /// Slowest functions seen so far (sorted, longest first)
+        ::std::vector<Func> slowest;
+        static const unsigned int N_SLOWEST = 10;
+
+        void add(Func f)
+        {
+            n_functions ++;
+            totals.passes += f.passes;
+            totals.ivars += f.ivars;
+            totals.coercion_checks += f.coercion_checks;
+            totals.assoc_checks += f.assoc_checks;
+            totals.rule_skips += f.rule_skips;
+            totals.trait_searches += f.trait_searches;
+            totals.seconds += f.seconds;
+
+            auto it = ::std::find_if(slowest.begin(), slowest.end(), [&](const Func& x){ return x.seconds < f.seconds; });
+            if( it != slowest.end() || slowest.size() < N_SLOWEST )
+            {
+                slowest.insert(it, mv$(f));
+                if( slowest.size() > N_SLOWEST )
+                    slowest.pop_back();
+            }
+        }
+    } g_solver_stats;
+
+    ::std::ostream& operator<<(::std::ostream& os, const SolverStats::Func& f)
+    {
+        return os << f.passes << " passes, " << f.ivars << " ivars, "
+            << f.coercion_checks << " coercion checks, " << f.assoc_checks << " associated checks (" << f.rule_skips << " skipped), "
+            << f.trait_searches << " trait impl searches";
+    }
+}
+
+void Typecheck_EnableSolverStats(unsigned int warn_ms, unsigned int warn_passes, bool dump_stalled)
+{
+    g_solver_stats.enabled = true;
+    g_solver_stats.warn_ms = warn_ms;
+    g_solver_stats.warn_passes = warn_passes;
+    g_solver_stats.dump_stalled = dump_stalled;
+}
+void Typecheck_PrintSolverStats(::std::ostream& os)
+{
+    const auto& s = g_solver_stats;
+    if( !s.enabled )
+        return ;
+    os << "Typecheck: " << s.n_functions << " bodies, " << s.totals.seconds * 1000 << " ms - " << s.totals << ::std::endl;
+    for(const auto& f : s.slowest)
+    {
+        os << "  " << f.seconds * 1000 << " ms " << f.sp << " - " << f << ::std::endl;
+    }
+}
+
 void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr)
 {
     TRACE_FUNCTION;
+    auto start_time = clock();
 
     auto root_ptr = expr.into_unique();
     Context context { ms.m_crate, ms.m_impl_generics, ms.m_item_generics };
@@ -5811,21 +5944,73 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
         context.equate_types_coerce(sp, new_res_ty, root_ptr);
     }
 
+    // Coercion/associated rules that made no progress remember which ivars they looked at, and are only re-checked once
+    // one of those ivars is bound/refined (or the rule set changes). Skipped rules replay their recorded possibilities
+    // so the ivar possibility pass sees the same input.
+    unsigned int n_coerce_checks = 0;
+    unsigned int n_assoc_checks = 0;
+    unsigned int n_rule_skips = 0;
+    auto rule_is_waiting = [&](const Context::RuleWait& wait)->bool {
+        if( !wait.valid || wait.epoch != context.rule_epoch() || !context.m_ivars.ivars_unchanged_since(wait.ivars, wait.generation) )
+            return false;
+        for(const auto& r : wait.possibles)
+        {
+            if( r.is_disable )
+                context.possible_equate_type_disable(r.ivar_index, r.is_to);
+            else
+                context.possible_equate_type(r.ivar_index, r.ty, r.is_to, r.is_borrow);
+        }
+        n_rule_skips ++;
+        return true;
+        };
+    auto rule_check_start = [&](Context::RuleWait& wait) {
+        wait.valid = false;
+        wait.possibles.clear();
+        wait.generation = context.m_ivars.generation();
+        wait.epoch = context.rule_epoch();
+        context.m_possible_record = &wait.possibles;
+        };
+    // Returns true if the rule made no progress (and can wait for its ivars to change)
+    auto rule_check_end = [&](Context::RuleWait& wait)->bool {
+        if( wait.generation != context.m_ivars.generation() || wait.epoch != context.rule_epoch() )
+            return false;
+        wait.valid = true;
+        wait.ivars.clear();
+        return true;
+        };
+
     const unsigned int MAX_ITERATIONS = 1000;
     unsigned int count = 0;
     while( context.take_changed() /*&& context.has_rules()*/ && count < MAX_ITERATIONS )
     {
         TRACE_FUNCTION_F("=== PASS " << count << " ===");
         context.dump();
+        if( g_solver_stats.dump_stalled && count + 1 == (g_solver_stats.warn_passes ? g_solver_stats.warn_passes : MAX_ITERATIONS) )
+        {
+            ::std::cerr << root_ptr->span() << ": Typecheck pass " << count << " rules - ";
+            context.dump_rules(::std::cerr);
+        }
 
         // 1. Check coercions for ones that cannot coerce due to RHS type (e.g. `str` which doesn't coerce to anything)
         // 2. (???) Locate coercions that cannot coerce (due to being the only way to know a type)
         // - Keep a list in the ivar of what types that ivar could be equated to.
         DEBUG("--- Coercion checking");
         for(auto it = context.link_coerce.begin(); it != context.link_coerce.end(); ) {
+            if( rule_is_waiting(it->wait) ) {
+                ++ it;
+                continue ;
+            }
             const auto& src_ty = (**it->right_node_ptr).m_res_type;
             it->left_ty = context.m_resolve.expand_associated_types( (*it->right_node_ptr)->span(), mv$(it->left_ty) );
-            if( check_coerce(context, *it) ) {
+            rule_check_start(it->wait);
+            n_coerce_checks ++;
+            bool consumed = check_coerce(context, *it);
+            if( !consumed && rule_check_end(it->wait) ) {
+                context.m_ivars.get_type_ivars(it->left_ty, it->wait.ivars);
+                context.m_ivars.get_type_ivars((**it->right_node_ptr).m_res_type, it->wait.ivars);
+            }
+            context.m_possible_record = nullptr;
+            if( consumed ) {
                 DEBUG("- Consumed coercion " << it->left_ty << " := " << src_ty);
 
                 #if 1
@@ -5848,6 +6033,10 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
         // 3. Check associated type rules
         DEBUG("--- Associated types");
         for(unsigned int i = 0; i < context.link_assoc.size(); ) {
+            if( rule_is_waiting(context.link_assoc[i].wait) ) {
+                i ++;
+                continue ;
+            }
             // - Move out (and back in later) to avoid holding a bad pointer if the list is updated
             auto rule = mv$(context.link_assoc[i]);
 
@@ -5860,7 +6049,17 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
             }
             rule.impl_ty = context.m_resolve.expand_associated_types(rule.span, mv$(rule.impl_ty));
 
-            if( check_associated(context, rule) ) {
+            rule_check_start(rule.wait);
+            n_assoc_checks ++;
+            bool consumed = check_associated(context, rule);
+            if( !consumed && rule_check_end(rule.wait) ) {
+                context.m_ivars.get_type_ivars(rule.left_ty, rule.wait.ivars);
+                context.m_ivars.get_type_ivars(rule.impl_ty, rule.wait.ivars);
+                for(const auto& ty : rule.params.m_types)
+                    context.m_ivars.get_type_ivars(ty, rule.wait.ivars);
+            }
+            context.m_possible_record = nullptr;
+            if( consumed ) {
                 DEBUG("- Consumed associated type rule " << i << "/" << context.link_assoc.size() << " - " << rule);
                 if( i != context.link_assoc.size()-1 )
                 {
@@ -5951,6 +6150,25 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
         count ++;
         context.m_resolve.compact_ivars(context.m_ivars);
     }
+    DEBUG("Rule checks: " << n_coerce_checks + n_assoc_checks << " run, " << n_rule_skips << " skipped (waiting on ivars)");
+    if( g_solver_stats.enabled )
+    {
+        SolverStats::Func   f;
+        f.sp = root_ptr->span();
+        f.passes = count;
+        f.ivars = context.m_ivars.m_ivars.size();
+        f.coercion_checks = n_coerce_checks;
+        f.assoc_checks = n_assoc_checks;
+        f.rule_skips = n_rule_skips;
+        f.trait_searches = context.m_resolve.trait_search_count();
+        f.seconds = static_cast<double>(clock() - start_time) / static_cast<double>(CLOCKS_PER_SEC);
+
+        if( (g_solver_stats.warn_ms && f.seconds * 1000 >= g_solver_stats.warn_ms) || (g_solver_stats.warn_passes && f.passes >= g_solver_stats.warn_passes) )
+        {
+            WARNING(f.sp, W0000, "Slow typecheck - " << f.seconds * 1000 << " ms, " << f);
+        }
+        g_solver_stats.add(mv$(f));
+    }
     if( count == MAX_ITERATIONS ) {
         BUG(root_ptr->span(), "Typecheck ran for too many iterations, max - " << MAX_ITERATIONS);
     }
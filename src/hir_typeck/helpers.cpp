@@ -18,7 +18,7 @@ void HMTypeInferrence::dump() const
             //DEBUG("#" << i << " = " << v.alias);
         }
         else {
-            DEBUG("#" << i << " = " << *v.type << FMT_CB(os,
+            DEBUG("#" << i << " = " << v.type << FMT_CB(os,
                 bool open = false;
                 unsigned int i2 = 0;
                 for(const auto& v2 : m_ivars) {
@@ -69,13 +69,13 @@ void HMTypeInferrence::check_for_loops()
             TU_MATCH( ::HIR::TypeRef::Data, (ty.m_data), (e),
             (Infer,
                 for(auto idx : m_indexes)
-                    ASSERT_BUG(Span(), e.index != idx, "Recursion in ivar #" << m_indexes.front() << " " << *ivars.m_ivars[m_indexes.front()].type
-                        << " - loop with " << idx << " " << *ivars.m_ivars[idx].type);
+                    ASSERT_BUG(Span(), e.index != idx, "Recursion in ivar #" << m_indexes.front() << " " << ivars.m_ivars[m_indexes.front()].type
+                        << " - loop with " << idx << " " << ivars.m_ivars[idx].type);
                 const auto& ivd = ivars.get_pointed_ivar(e.index);
                 assert( !ivd.is_alias() );
-                if( !ivd.type->m_data.is_Infer() ) {
+                if( !ivd.type.m_data.is_Infer() ) {
                     m_indexes.push_back( e.index );
-                    this->check_ty(ivars, *ivd.type);
+                    this->check_ty(ivars, ivd.type);
                     m_indexes.pop_back( );
                 }
                 ),
@@ -133,10 +133,10 @@ void HMTypeInferrence::check_for_loops()
     unsigned int i = 0;
     for(const auto& v : m_ivars)
     {
-        if( !v.is_alias() && !v.type->m_data.is_Infer() )
+        if( !v.is_alias() && !v.type.m_data.is_Infer() )
         {
-            DEBUG("- " << i << " " << *v.type);
-            (LoopChecker { {i} }).check_ty(*this, *v.type);
+            DEBUG("- " << i << " " << v.type);
+            (LoopChecker { {i} }).check_ty(*this, v.type);
         }
         i ++;
     }
@@ -149,11 +149,11 @@ void HMTypeInferrence::compact_ivars()
     for(auto& v : m_ivars)
     {
         if( !v.is_alias() ) {
-            //auto nt = this->expand_associated_types(Span(), v.type->clone());
-            auto nt = v.type->clone();
+            //auto nt = this->expand_associated_types(Span(), v.type.clone());
+            auto nt = v.type.clone();
 
-            DEBUG("- " << i << " " << *v.type << " -> " << nt);
-            *v.type = mv$(nt);
+            DEBUG("- " << i << " " << v.type << " -> " << nt);
+            v.type = mv$(nt);
         }
         else {
 
@@ -181,25 +181,28 @@ bool HMTypeInferrence::apply_defaults()
     for(auto& v : m_ivars)
     {
         if( !v.is_alias() ) {
-            TU_IFLET(::HIR::TypeRef::Data, v.type->m_data, Infer, e,
+            TU_IFLET(::HIR::TypeRef::Data, v.type.m_data, Infer, e,
                 switch(e.ty_class)
                 {
                 case ::HIR::InferClass::None:
                     break;
                 case ::HIR::InferClass::Diverge:
                     rv = true;
-                    DEBUG("- " << *v.type << " -> !");
-                    *v.type = ::HIR::TypeRef(::HIR::TypeRef::Data::make_Diverge({}));
+                    DEBUG("- " << v.type << " -> !");
+                    v.type = ::HIR::TypeRef(::HIR::TypeRef::Data::make_Diverge({}));
+                    this->stamp_ivar(v);
                     break;
                 case ::HIR::InferClass::Integer:
                     rv = true;
-                    DEBUG("- " << *v.type << " -> i32");
-                    *v.type = ::HIR::TypeRef( ::HIR::CoreType::I32 );
+                    DEBUG("- " << v.type << " -> i32");
+                    v.type = ::HIR::TypeRef( ::HIR::CoreType::I32 );
+                    this->stamp_ivar(v);
                     break;
                 case ::HIR::InferClass::Float:
                     rv = true;
-                    DEBUG("- " << *v.type << " -> f64");
-                    *v.type = ::HIR::TypeRef( ::HIR::CoreType::F64 );
+                    DEBUG("- " << v.type << " -> f64");
+                    v.type = ::HIR::TypeRef( ::HIR::CoreType::F64 );
+                    this->stamp_ivar(v);
                     break;
                 }
             )
@@ -508,10 +511,32 @@ void HMTypeInferrence::add_ivars_params(::HIR::PathParams& params)
 
 
 
+void HMTypeInferrence::get_type_ivars(const ::HIR::TypeRef& ty, ::std::vector<unsigned int>& out) const
+{
+    visit_ty_with(ty, [&](const auto& t)->bool {
+        if( const auto* e = t.m_data.opt_Infer() )
+        {
+            auto index = e->index;
+            if( index == ~0u )
+                return false;
+            out.push_back(index);
+            while( m_ivars.at(index).is_alias() ) {
+                index = m_ivars.at(index).alias;
+                out.push_back(index);
+            }
+            const auto& root = m_ivars.at(index).type;
+            if( !root.m_data.is_Infer() ) {
+                this->get_type_ivars(root, out);
+            }
+        }
+        return false;
+        });
+}
+
 unsigned int HMTypeInferrence::new_ivar()
 {
     m_ivars.push_back( IVar() );
-    m_ivars.back().type->m_data.as_Infer().index = m_ivars.size() - 1;
+    m_ivars.back().type.m_data.as_Infer().index = m_ivars.size() - 1;
     return m_ivars.size() - 1;
 }
 ::HIR::TypeRef HMTypeInferrence::new_ivar_tr()
@@ -525,7 +550,7 @@ unsigned int HMTypeInferrence::new_ivar()
 {
     TU_IFLET(::HIR::TypeRef::Data, type.m_data, Infer, e,
         assert(e.index != ~0u);
-        return *get_pointed_ivar(e.index).type;
+        return get_pointed_ivar(e.index).type;
     )
     else {
         return type;
@@ -536,7 +561,7 @@ const ::HIR::TypeRef& HMTypeInferrence::get_type(const ::HIR::TypeRef& type) con
 {
     TU_IFLET(::HIR::TypeRef::Data, type.m_data, Infer, e,
         assert(e.index != ~0u);
-        return *get_pointed_ivar(e.index).type;
+        return get_pointed_ivar(e.index).type;
     )
     else {
         return type;
@@ -547,7 +572,7 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
 {
     auto sp = Span();
     auto& root_ivar = this->get_pointed_ivar(slot);
-    DEBUG("set_ivar_to(" << slot << " { " << *root_ivar.type << " }, " << type << ")");
+    DEBUG("set_ivar_to(" << slot << " { " << root_ivar.type << " }, " << type << ")");
 
     // If the left type was '_', alias the right to it
     TU_IFLET(::HIR::TypeRef::Data, type.m_data, Infer, l_e,
@@ -555,9 +580,9 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
         DEBUG("Set IVar " << slot << " = @" << l_e.index);
 
         if( l_e.ty_class != ::HIR::InferClass::None ) {
-            TU_MATCH_DEF(::HIR::TypeRef::Data, (root_ivar.type->m_data), (e),
+            TU_MATCH_DEF(::HIR::TypeRef::Data, (root_ivar.type.m_data), (e),
             (
-                ERROR(sp, E0000, "Type unificiation of literal with invalid type - " << *root_ivar.type);
+                ERROR(sp, E0000, "Type unificiation of literal with invalid type - " << root_ivar.type);
                 ),
             (Primitive,
                 check_type_class_primitive(sp, type, l_e.ty_class, e);
@@ -565,22 +590,22 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
             (Infer,
                 // Check for right having a ty_class
                 if( e.ty_class != ::HIR::InferClass::None && e.ty_class != l_e.ty_class ) {
-                    ERROR(sp, E0000, "Unifying types with mismatching literal classes - " << type << " := " << *root_ivar.type);
+                    ERROR(sp, E0000, "Unifying types with mismatching literal classes - " << type << " := " << root_ivar.type);
                 }
                 )
             )
         }
 
         root_ivar.alias = l_e.index;
-        root_ivar.type.reset();
+        root_ivar.type = ::HIR::TypeRef();
     )
-    else if( *root_ivar.type == type ) {
+    else if( root_ivar.type == type ) {
         return ;
     }
     else {
         // Otherwise, store left in right's slot
         DEBUG("Set IVar " << slot << " = " << type);
-        TU_IFLET(::HIR::TypeRef::Data, root_ivar.type->m_data, Infer, e,
+        TU_IFLET(::HIR::TypeRef::Data, root_ivar.type.m_data, Infer, e,
             switch(e.ty_class)
             {
             case ::HIR::InferClass::None:
@@ -600,24 +625,25 @@ void HMTypeInferrence::set_ivar_to(unsigned int slot, ::HIR::TypeRef type)
             }
         )
         #if 0
-        else TU_IFLET(::HIR::TypeRef::Data, root_ivar.type->m_data, Diverge, e,
+        else TU_IFLET(::HIR::TypeRef::Data, root_ivar.type.m_data, Diverge, e,
             // Overwriting ! with anything is valid (it's like a magic ivar)
         )
         #endif
         else {
-            BUG(sp, "Overwriting ivar " << slot << " (" << *root_ivar.type << ") with " << type);
+            BUG(sp, "Overwriting ivar " << slot << " (" << root_ivar.type << ") with " << type);
         }
 
         #if 1
         TU_IFLET(::HIR::TypeRef::Data, type.m_data, Diverge, e,
-            root_ivar.type->m_data.as_Infer().ty_class = ::HIR::InferClass::Diverge;
+            root_ivar.type.m_data.as_Infer().ty_class = ::HIR::InferClass::Diverge;
         )
         else
         #endif
-        root_ivar.type = box$( mv$(type) );
+        root_ivar.type = mv$(type);
     }
 
-    this->mark_change();
+    this->stamp_ivar(root_ivar);
+    this->set_changed();
 }
 
 void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slot)
@@ -630,10 +656,10 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
         // TODO: Assert that setting this won't cause a loop.
         auto& root_ivar = this->get_pointed_ivar(right_slot);
 
-        TU_IFLET(::HIR::TypeRef::Data, root_ivar.type->m_data, Infer, re,
+        TU_IFLET(::HIR::TypeRef::Data, root_ivar.type.m_data, Infer, re,
             if( re.ty_class == ::HIR::InferClass::Diverge )
             {
-                TU_IFLET(::HIR::TypeRef::Data, left_ivar.type->m_data, Infer, le,
+                TU_IFLET(::HIR::TypeRef::Data, left_ivar.type.m_data, Infer, le,
                     if( le.ty_class == ::HIR::InferClass::None ) {
                         le.ty_class = ::HIR::InferClass::Diverge;
                     }
@@ -641,9 +667,9 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
             }
             else if(re.ty_class != ::HIR::InferClass::None)
             {
-                TU_MATCH_DEF(::HIR::TypeRef::Data, (left_ivar.type->m_data), (le),
+                TU_MATCH_DEF(::HIR::TypeRef::Data, (left_ivar.type.m_data), (le),
                 (
-                    ERROR(sp, E0000, "Type unificiation of literal with invalid type - " << *left_ivar.type);
+                    ERROR(sp, E0000, "Type unificiation of literal with invalid type - " << left_ivar.type);
                     ),
                 (Infer,
                     if( le.ty_class == ::HIR::InferClass::Diverge )
@@ -651,7 +677,7 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
                     }
                     else if( le.ty_class != ::HIR::InferClass::None && le.ty_class != re.ty_class )
                     {
-                        ERROR(sp, E0000, "Unifying types with mismatching literal classes - " << *left_ivar.type << " := " << *root_ivar.type);
+                        ERROR(sp, E0000, "Unifying types with mismatching literal classes - " << left_ivar.type << " := " << root_ivar.type);
                     }
                     else
                     {
@@ -659,7 +685,7 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
                     le.ty_class = re.ty_class;
                     ),
                 (Primitive,
-                    check_type_class_primitive(sp, *left_ivar.type, re.ty_class, le);
+                    check_type_class_primitive(sp, left_ivar.type, re.ty_class, le);
                     )
                 )
             }
@@ -668,17 +694,20 @@ void HMTypeInferrence::ivar_unify(unsigned int left_slot, unsigned int right_slo
             }
         )
         else {
-            BUG(sp, "Unifying over a concrete type - " << *root_ivar.type);
+            BUG(sp, "Unifying over a concrete type - " << root_ivar.type);
         }
 
-        DEBUG("IVar " << root_ivar.type->m_data.as_Infer().index << " = @" << left_slot);
+        DEBUG("IVar " << root_ivar.type.m_data.as_Infer().index << " = @" << left_slot);
         root_ivar.alias = left_slot;
-        root_ivar.type.reset();
+        root_ivar.type = ::HIR::TypeRef();
 
-        this->mark_change();
+        // Both sides change: the left may have gained a class, the right is now an alias
+        this->stamp_ivar(left_ivar);
+        this->stamp_ivar(root_ivar);
+        this->set_changed();
     }
 }
-HMTypeInferrence::IVar& HMTypeInferrence::get_pointed_ivar(unsigned int slot) const
+unsigned int HMTypeInferrence::get_root_ivar_index(unsigned int slot) const
 {
     auto index = slot;
     unsigned int count = 0;
@@ -692,7 +721,24 @@ HMTypeInferrence::IVar& HMTypeInferrence::get_pointed_ivar(unsigned int slot) co
         }
         count ++;
     }
-    return const_cast<IVar&>(m_ivars.at(index));
+    return index;
+}
+const HMTypeInferrence::IVar& HMTypeInferrence::get_pointed_ivar(unsigned int slot) const
+{
+    return m_ivars.at( this->get_root_ivar_index(slot) );
+}
+HMTypeInferrence::IVar& HMTypeInferrence::get_pointed_ivar(unsigned int slot)
+{
+    auto index = this->get_root_ivar_index(slot);
+    // Path compression: point every ivar on the chain directly at the root, so later lookups are a single step.
+    // - Only the chain representation changes, the resolved type of each ivar is unaffected.
+    auto cur = slot;
+    while( cur != index && m_ivars[cur].alias != index ) {
+        auto next = m_ivars[cur].alias;
+        m_ivars[cur].alias = index;
+        cur = next;
+    }
+    return m_ivars.at(index);
 }
 
 bool HMTypeInferrence::pathparams_contain_ivars(const ::HIR::PathParams& pps) const {
@@ -921,8 +967,7 @@ bool HMTypeInferrence::types_equal(const ::HIR::TypeRef& rl, const ::HIR::TypeRe
 // --------------------------------------------------------------------
 void TraitResolution::prep_indexes()
 {
-    static Span sp_AAA;
-    const Span& sp = sp_AAA;
+    static const Span  sp;
 
     auto add_equality = [&](::HIR::TypeRef long_ty, ::HIR::TypeRef short_ty){
         DEBUG("[prep_indexes] ADD " << long_ty << " => " << short_ty);
@@ -1026,11 +1071,12 @@ bool TraitResolution::find_trait_impls(const Span& sp,
         t_cb_trait_impl_r callback
         ) const
 {
-    static ::HIR::PathParams    null_params;
-    static ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
+    static const ::HIR::PathParams    null_params;
+    static const ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
 
     const auto& type = this->m_ivars.get_type(ty);
     TRACE_FUNCTION_F("trait = " << trait << params  << ", type = " << type);
+    m_trait_search_count ++;
 
     const auto& lang_Sized = this->m_crate.get_lang_item_path(sp, "sized");
     const auto& lang_Copy = this->m_crate.get_lang_item_path(sp, "copy");
@@ -1314,7 +1360,7 @@ bool TraitResolution::find_trait_impls(const Span& sp,
             if( trait == mt.m_path ) {
                 auto cmp = compare_pp(sp, mt.m_params, params);
                 if( cmp != ::HIR::Compare::Unequal ) {
-                    static ::std::map< ::std::string, ::HIR::TypeRef>  types;
+                    static const ::std::map< ::std::string, ::HIR::TypeRef>  types;
                     return callback( ImplRef(&type, &mt.m_params, &types), cmp );
                 }
             }
@@ -1552,13 +1598,16 @@ void TraitResolution::compact_ivars(HMTypeInferrence& m_ivars)
     for(auto& v : m_ivars.m_ivars)
     {
         if( !v.is_alias() ) {
-            m_ivars.expand_ivars( *v.type );
+            m_ivars.expand_ivars( v.type );
             // Don't expand unless it is needed
-            if( this->has_associated_type(*v.type) ) {
+            if( this->has_associated_type(v.type) ) {
                 // TODO: cloning is expensive, BUT printing below is nice
-                auto nt = this->expand_associated_types(Span(), v.type->clone());
-                DEBUG("- " << i << " " << *v.type << " -> " << nt);
-                *v.type = mv$(nt);
+                auto nt = this->expand_associated_types(Span(), v.type.clone());
+                DEBUG("- " << i << " " << v.type << " -> " << nt);
+                if( nt != v.type ) {
+                    m_ivars.stamp_ivar(v);
+                }
+                v.type = mv$(nt);
             }
         }
         else {
@@ -1773,6 +1822,27 @@ void TraitResolution::expand_associated_types_inplace(const Span& sp, ::HIR::Typ
 
 
 void TraitResolution::expand_associated_types_inplace__UfcsKnown(const Span& sp, ::HIR::TypeRef& input, LList<const ::HIR::TypeRef*> prev_stack) const
+{
+    // Only outermost lookups are cached, nested ones can be cut short by the recursion check
+    bool cacheable = m_eat_active_stack.empty() && !visit_ty_with(input, [](const auto& t){ return t.m_data.is_Infer(); });
+    if( !cacheable )
+    {
+        this->expand_associated_types_inplace__UfcsKnown_inner(sp, input, prev_stack);
+        return ;
+    }
+    auto it = m_projection_cache.find(input);
+    if( it != m_projection_cache.end() )
+    {
+        g_projection_cache_stats_typeck.hits ++;
+        input = it->second.clone();
+        return ;
+    }
+    g_projection_cache_stats_typeck.misses ++;
+    auto key = input.clone();
+    this->expand_associated_types_inplace__UfcsKnown_inner(sp, input, prev_stack);
+    m_projection_cache.insert( ::std::make_pair(mv$(key), input.clone()) );
+}
+void TraitResolution::expand_associated_types_inplace__UfcsKnown_inner(const Span& sp, ::HIR::TypeRef& input, LList<const ::HIR::TypeRef*> prev_stack) const
 {
     TRACE_FUNCTION_FR("input=" << input, input);
     auto& e = input.m_data.as_Path();
@@ -2379,14 +2449,14 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         t_cb_trait_impl_r callback
         ) const
 {
-    static ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
+    static const ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
     TRACE_FUNCTION_F(trait << FMT_CB(ss, if(params_ptr) { ss << *params_ptr; } else { ss << "<?>"; }) << " for " << type);
 
     // Handle auto traits (aka OIBITs)
     if( m_crate.get_trait_by_path(sp, trait).m_is_marker )
     {
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        auto& stack = m_auto_trait_stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait )
                 continue ;
@@ -2399,9 +2469,10 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         }
         stack.push_back( ::std::make_tuple( &trait, params_ptr, &type ) );
         struct Guard {
-            ~Guard() { stack.pop_back(); }
+            decltype(stack)& s;
+            ~Guard() { s.pop_back(); }
         };
-        Guard   _;
+        Guard   _ { stack };
 
         // NOTE: Expected behavior is for Ivars to return false
         // TODO: Should they return Compare::Fuzzy instead?
@@ -3309,6 +3380,30 @@ unsigned int TraitResolution::autoderef_find_method(const Span& sp, const HIR::t
     return os;
 }
 
+const ::std::vector<TraitResolution::TraitMethodCand>& TraitResolution::get_trait_method_candidates(const HIR::t_trait_list& traits, const ::std::string& method_name) const
+{
+    auto key = ::std::make_pair(method_name, traits);
+    auto it = m_trait_method_cache.find(key);
+    if( it != m_trait_method_cache.end() )
+        return it->second;
+
+    ::std::vector<TraitMethodCand>  cands;
+    for(const auto& trait_ref : ::reverse(traits))
+    {
+        if( trait_ref.first == nullptr )
+            break;
+        // TODO: Shouldn't this use trait_contains_method?
+        // TODO: Search supertraits too
+        auto it = trait_ref.second->m_values.find(method_name);
+        if( it == trait_ref.second->m_values.end() )
+            continue ;
+        if( !it->second.is_Function() )
+            continue ;
+        cands.push_back( TraitMethodCand(trait_ref, &it->second.as_Function()) );
+    }
+    return m_trait_method_cache.insert( ::std::make_pair(mv$(key), mv$(cands)) ).first->second;
+}
+
 bool TraitResolution::find_method(
     const Span& sp,
     const HIR::t_trait_list& traits, const ::std::vector<unsigned>& ivars,
@@ -3492,13 +3587,9 @@ bool TraitResolution::find_method(
     }
     else {
         // 2. Search for inherent methods
-        bool rv = m_crate.find_type_impls(ty, m_ivars.callback_resolve_infer(), [&](const auto& impl) {
+        bool rv = m_crate.find_type_impl_methods(ty, method_name, m_ivars.callback_resolve_infer(), [&](const auto& impl, const ::HIR::Function& fcn) {
             // TODO: Should this take into account the actual suitability of this method? Or just that the name exists?
             // - If this impl matches fuzzily, it may not actually match
-            auto it = impl.m_methods.find( method_name );
-            if( it == impl.m_methods.end() )
-                return false ;
-            const ::HIR::Function&  fcn = it->second.data;
             switch(fcn.m_receiver)
             {
             case ::HIR::Function::Receiver::Free:
@@ -3530,10 +3621,9 @@ bool TraitResolution::find_method(
     }
 
     // 3. Search for trait methods (using currently in-scope traits)
-    for(const auto& trait_ref : ::reverse(traits))
+    for(const auto& cand : this->get_trait_method_candidates(traits, method_name))
     {
-        if( trait_ref.first == nullptr )
-            break;
+        const auto& trait_ref = cand.first;
         DEBUG("Search " << *trait_ref.first);
 
         //::HIR::GenericPath final_trait_path;
@@ -3541,14 +3631,7 @@ bool TraitResolution::find_method(
         //    continue ;
         //DEBUG("- Found trait " << final_trait_path);
 
-        // TODO: Shouldn't this use trait_contains_method?
-        // TODO: Search supertraits too
-        auto it = trait_ref.second->m_values.find(method_name);
-        if( it == trait_ref.second->m_values.end() )
-            continue ;
-        if( !it->second.is_Function() )
-            continue ;
-        const auto& v = it->second.as_Function();
+        const auto& v = *cand.second;
         switch(v.m_receiver)
         {
         case ::HIR::Function::Receiver::Free:
@@ -9,6 +9,7 @@
 
 #include <hir/hir.hpp>
 #include <hir/expr.hpp> // t_trait_list
+#include <deque>
 
 #include "common.hpp"
 
@@ -58,21 +59,30 @@ public: // ?? - Needed once, anymore?
     struct IVar
     {
         unsigned int alias; // If not ~0, this points to another ivar
-        ::std::unique_ptr< ::HIR::TypeRef> type;    // Type (only nullptr if alias!=0)
+        ::HIR::TypeRef  type;   // Type (unused if alias!=~0)
+        unsigned int changed_at;    // Value of `m_generation` when this ivar was last bound/refined
 
         IVar():
             alias(~0u),
-            type(new ::HIR::TypeRef())
+            changed_at(0)
         {}
         bool is_alias() const { return alias != ~0u; }
     };
 
-    ::std::vector< IVar>    m_ivars;
+    /// Ivar storage, types are held inline
+    /// - A deque so references returned by `get_type` stay valid when new ivars are created
+    ::std::deque< IVar>    m_ivars;
     bool    m_has_changed;
+    /// Incremented every time an ivar is bound or refined (stored in `IVar::changed_at`)
+    unsigned int    m_generation;
+    /// Incremented by every external `mark_change` (new rules, rewritten nodes)
+    unsigned int    m_change_epoch;
 
 public:
     HMTypeInferrence():
-        m_has_changed(false)
+        m_has_changed(false),
+        m_generation(0),
+        m_change_epoch(0)
     {}
 
     bool peek_changed() const {
@@ -84,10 +94,24 @@ public:
         return rv;
     }
     void mark_change() {
-        if( !m_has_changed ) {
-            DEBUG("- CHANGE");
-            m_has_changed = true;
-        }
+        m_change_epoch ++;
+        set_changed();
+    }
+
+    unsigned int generation() const { return m_generation; }
+    unsigned int change_epoch() const { return m_change_epoch; }
+    /// Record that the ivar's value changed (without requesting another pass)
+    void stamp_ivar(IVar& ivar) {
+        ivar.changed_at = ++m_generation;
+    }
+    /// Append every ivar that `ty` depends on (including alias chains) to `out`
+    void get_type_ivars(const ::HIR::TypeRef& ty, ::std::vector<unsigned int>& out) const;
+    /// Returns true if none of the listed ivars have changed since generation `gen`
+    bool ivars_unchanged_since(const ::std::vector<unsigned int>& ivars, unsigned int gen) const {
+        for(auto idx : ivars)
+            if( m_ivars[idx].changed_at > gen )
+                return false;
+        return true;
     }
 
     void compact_ivars();
@@ -139,7 +163,16 @@ public:
     bool pathparams_equal(const ::HIR::PathParams& pps_l, const ::HIR::PathParams& pps_r) const;
     bool types_equal(const ::HIR::TypeRef& l, const ::HIR::TypeRef& r) const;
 private:
-    IVar& get_pointed_ivar(unsigned int slot) const;
+    unsigned int get_root_ivar_index(unsigned int slot) const;
+    const IVar& get_pointed_ivar(unsigned int slot) const;
+    /// Mutable lookup, also compresses the alias chain starting at `slot`
+    IVar& get_pointed_ivar(unsigned int slot);
+    void set_changed() {
+        if( !m_has_changed ) {
+            DEBUG("- CHANGE");
+            m_has_changed = true;
+        }
+    }
 };
 
 class TraitResolution
@@ -154,6 +187,15 @@ class TraitResolution
 
     ::HIR::SimplePath   m_lang_Box;
     mutable ::std::vector< ::HIR::TypeRef>  m_eat_active_stack;
+    /// Auto trait queries currently being evaluated (used to detect recursion)
+    mutable ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    m_auto_trait_stack;
+    /// Expansions of ivar-free `UfcsKnown` projections (the in-scope generics are fixed for the lifetime of this object)
+    mutable ::std::map< ::HIR::TypeRef, ::HIR::TypeRef> m_projection_cache;
+    /// In-scope traits defining a method, for a (method name, in-scope trait list) pair (see `get_trait_method_candidates`)
+    typedef ::std::pair< ::std::pair<const ::HIR::SimplePath*,const ::HIR::Trait*>, const ::HIR::Function*>    TraitMethodCand;
+    mutable ::std::map< ::std::pair< ::std::string, HIR::t_trait_list>, ::std::vector<TraitMethodCand> >   m_trait_method_cache;
+    /// Number of `find_trait_impls` calls (reported by the typecheck solver statistics)
+    mutable unsigned int    m_trait_search_count = 0;
 public:
     TraitResolution(const HMTypeInferrence& ivars, const ::HIR::Crate& crate, const ::HIR::GenericParams* impl_params, const ::HIR::GenericParams* item_params):
         m_ivars(ivars),
@@ -176,6 +218,8 @@ public:
 
     void prep_indexes();
 
+    unsigned int trait_search_count() const { return m_trait_search_count; }
+
     ::HIR::Compare compare_pp(const Span& sp, const ::HIR::PathParams& left, const ::HIR::PathParams& right) const;
 
     void compact_ivars(HMTypeInferrence& m_ivars);
@@ -259,6 +303,9 @@ public:
     };
     friend ::std::ostream& operator<<(::std::ostream& os, const AllowedReceivers& x);
     bool find_method(const Span& sp, const HIR::t_trait_list& traits, const ::std::vector<unsigned>& ivars, const ::HIR::TypeRef& ty, const ::std::string& method_name, AllowedReceivers ar,  /* Out -> */::HIR::Path& fcn_path) const;
+private:
+    const ::std::vector<TraitMethodCand>& get_trait_method_candidates(const HIR::t_trait_list& traits, const ::std::string& method_name) const;
+public:
 
     /// Locates a named method in a trait, and returns the path of the trait that contains it (with fixed parameters)
     bool trait_contains_method(const Span& sp, const ::HIR::GenericPath& trait_path, const ::HIR::Trait& trait_ptr, const ::HIR::TypeRef& self, const ::std::string& name, AllowedReceivers ar,  ::HIR::GenericPath& out_path) const;
@@ -270,5 +317,6 @@ public:
 private:
     void expand_associated_types_inplace(const Span& sp, ::HIR::TypeRef& input, LList<const ::HIR::TypeRef*> stack) const;
     void expand_associated_types_inplace__UfcsKnown(const Span& sp, ::HIR::TypeRef& input, LList<const ::HIR::TypeRef*> stack) const;
+    void expand_associated_types_inplace__UfcsKnown_inner(const Span& sp, ::HIR::TypeRef& input, LList<const ::HIR::TypeRef*> stack) const;
 };
 
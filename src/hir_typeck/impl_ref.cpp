@@ -186,7 +186,7 @@ bool ImplRef::type_is_specialisable(const char* name) const
 {
     if( !name[0] )
         return ::HIR::TypeRef();
-    static Span  sp;
+    static const Span  sp;
     TU_MATCH(Data, (this->m_data), (e),
     (TraitImpl,
         DEBUG("name=" << name << " " << *this);
@@ -2,6 +2,8 @@
  */
 #pragma once
 
+#include <iosfwd>
+
 namespace HIR {
     class Crate;
 };
@@ -9,3 +11,12 @@ namespace HIR {
 extern void Typecheck_ModuleLevel(::HIR::Crate& crate);
 extern void Typecheck_Expressions(::HIR::Crate& crate);
 extern void Typecheck_Expressions_Validate(::HIR::Crate& crate);
+
+/// Print statistics from the trait resolution caches
+extern void Typecheck_PrintStats(::std::ostream& os);
+
+/// Collect per-function typecheck solver statistics (printed by `Typecheck_PrintSolverStats`)
+/// - Bodies taking at least `warn_ms` milliseconds or `warn_passes` solver passes emit a warning (0 = no limit)
+/// - `dump_stalled` prints the outstanding rules on the last pass before the pass limit
+extern void Typecheck_EnableSolverStats(unsigned int warn_ms, unsigned int warn_passes, bool dump_stalled);
+extern void Typecheck_PrintSolverStats(::std::ostream& os);
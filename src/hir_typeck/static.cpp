@@ -6,16 +6,49 @@
  * - Non-inferred type checking
  */
 #include "static.hpp"
+#include "main_bindings.hpp"
 #include <algorithm>
+#include <atomic>
+
+namespace {
+    // NOTE: Atomic, as resolvers can be used from several threads at once
+    struct FindImplStats {
+        ::std::atomic<unsigned int> uncacheable { 0 };
+        ::std::atomic<unsigned int> hits { 0 };
+        ::std::atomic<unsigned int> misses { 0 };
+        ::std::atomic<unsigned int> diverged { 0 };
+    } g_find_impl_stats;
+}
+
+ProjectionCacheStats g_projection_cache_stats_typeck;
+ProjectionCacheStats g_projection_cache_stats_static;
+
+void Typecheck_PrintStats(::std::ostream& os)
+{
+    const auto& s = g_find_impl_stats;
+    unsigned int hits = s.hits, misses = s.misses, diverged = s.diverged, uncacheable = s.uncacheable;
+    auto cached = hits + misses + diverged;
+    os << "StaticTraitResolve::find_impl: " << (cached + uncacheable) << " queries, "
+        << hits << " cache hits (" << (cached ? hits * 100 / cached : 0) << "% of cacheable), "
+        << misses << " misses, " << diverged << " diverged replays, "
+        << uncacheable << " uncacheable" << ::std::endl;
+    for(const auto& e : { ::std::make_pair("TraitResolution", &g_projection_cache_stats_typeck), ::std::make_pair("StaticTraitResolve", &g_projection_cache_stats_static) })
+    {
+        unsigned int hits = e.second->hits, misses = e.second->misses;
+        auto total = hits + misses;
+        os << e.first << " projections: " << total << " cacheable, " << hits << " cache hits (" << (total ? hits * 100 / total : 0) << "%)" << ::std::endl;
+    }
+}
 
 void StaticTraitResolve::prep_indexes()
 {
-    static Span sp_AAA;
-    const Span& sp = sp_AAA;
+    static const Span  sp;
 
     TRACE_FUNCTION_F("");
 
     m_copy_cache.clear();
+    m_projection_cache_generic.clear();
+    m_bounds_on_concrete = false;
 
     auto add_equality = [&](::HIR::TypeRef long_ty, ::HIR::TypeRef short_ty){
         DEBUG("[prep_indexes] ADD " << long_ty << " => " << short_ty);
@@ -29,6 +62,8 @@ void StaticTraitResolve::prep_indexes()
             ),
         (TraitBound,
             DEBUG("[prep_indexes] `" << be.type << " : " << be.trait);
+            if( !monomorphise_type_needed(be.type) )
+                m_bounds_on_concrete = true;
             for( const auto& tb : be.trait.m_type_bounds ) {
                 DEBUG("[prep_indexes] Equality (TB) - <" << be.type << " as " << be.trait.m_path << ">::" << tb.first << " = " << tb.second);
                 auto ty_l = ::HIR::TypeRef( ::HIR::Path( be.type.clone(), be.trait.m_path.clone(), tb.first ) );
@@ -77,6 +112,8 @@ void StaticTraitResolve::prep_indexes()
             ),
         (TypeEquality,
             DEBUG("Equality - " << be.type << " = " << be.other_type);
+            if( !monomorphise_type_needed(be.type) )
+                m_bounds_on_concrete = true;
             add_equality( be.type.clone(), be.other_type.clone() );
             )
         )
@@ -84,6 +121,14 @@ void StaticTraitResolve::prep_indexes()
         });
 }
 
+Ordering StaticTraitResolve::FindImplKey::ord(const FindImplKey& x) const
+{
+    ORD(trait, x.trait);
+    ORD(has_params, x.has_params);
+    ORD(params, x.params);
+    return ::ord(type, x.type);
+}
+
 bool StaticTraitResolve::find_impl(
     const Span& sp,
     const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
@@ -91,12 +136,150 @@ bool StaticTraitResolve::find_impl(
     t_cb_find_impl found_cb,
     bool dont_handoff_to_specialised
     ) const
+{
+    // Only queries that can't be affected by the in-scope generics are cached
+    // - Closure types are excluded, as their impls are added to the crate while the closure pass runs
+    auto is_cacheable = [](const ::HIR::TypeRef& ty) {
+        return !visit_ty_with(ty, [](const auto& t) {
+            return t.m_data.is_Generic() || t.m_data.is_Infer() || t.m_data.is_Closure() || t.m_data.is_ErasedType();
+            });
+        };
+    bool cacheable = !dont_handoff_to_specialised && !m_bounds_on_concrete && m_auto_trait_stack.empty() && is_cacheable(type);
+    if( cacheable && trait_params )
+    {
+        for(const auto& ty : trait_params->m_types)
+            if( !is_cacheable(ty) )
+                cacheable = false;
+    }
+    if( !cacheable )
+    {
+        g_find_impl_stats.uncacheable ++;
+        return this->find_impl__inner(sp, trait_path, trait_params, type, mv$(found_cb), dont_handoff_to_specialised);
+    }
+    return this->find_impl__cached(sp, trait_path, trait_params, type, mv$(found_cb));
+}
+
+bool StaticTraitResolve::find_impl__cached(
+    const Span& sp,
+    const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+    const ::HIR::TypeRef& type,
+    t_cb_find_impl found_cb
+    ) const
+{
+    FindImplKey key { trait_path, trait_params != nullptr, trait_params ? trait_params->clone() : ::HIR::PathParams(), type.clone() };
+
+    // Callback return values already seen by the caller (when re-running a search after a replay diverged)
+    ::std::vector<bool>  delivered;
+
+    auto it = m_find_impl_cache.find(key);
+    if( it != m_find_impl_cache.end() )
+    {
+        // Replay the candidates from the recorded search, as long as the callback makes the same choices the search
+        // would continue the same way.
+        // NOTE: Entries are never modified once inserted, so the references given to the callback stay valid.
+        const auto& ent = it->second;
+        for(const auto& c : ent.cands)
+        {
+            ImplRef ir;
+            if( c.impl )
+            {
+                ::std::vector<const ::HIR::TypeRef*>    params;
+                for(unsigned int i = 0; i < c.impl_params.size(); i ++)
+                    params.push_back( c.impl_params_set[i] ? &c.impl_params[i] : nullptr );
+                ::std::vector< ::HIR::TypeRef>  params_ph;
+                for(const auto& t : c.impl_params_ph)
+                    params_ph.push_back( t.clone() );
+                ir = ImplRef(mv$(params), it->first.trait, *c.impl, mv$(params_ph));
+            }
+            else if( c.is_ptr )
+            {
+                ir = ImplRef(&c.type, c.has_trait_args ? &c.trait_args : nullptr, &c.assoc);
+            }
+            else
+            {
+                ::std::map< ::std::string, ::HIR::TypeRef>  assoc;
+                for(const auto& e : c.assoc)
+                    assoc.insert( ::std::make_pair(e.first, e.second.clone()) );
+                ir = ImplRef(c.type.clone(), c.trait_args.clone(), mv$(assoc));
+            }
+            bool rv = found_cb( mv$(ir), c.is_fuzzy );
+            delivered.push_back(rv);
+            if( rv != c.cb_rv )
+                break;
+        }
+        if( delivered.size() == ent.cands.size() && (ent.cands.empty() || delivered.back() == ent.cands.back().cb_rv) )
+        {
+            g_find_impl_stats.hits ++;
+            return ent.rv;
+        }
+        // The callback chose differently, so the search could go elsewhere - re-run it (without re-delivering)
+        DEBUG("find_impl cache replay diverged after " << delivered.size() << " candidates");
+        g_find_impl_stats.diverged ++;
+    }
+    else
+    {
+        g_find_impl_stats.misses ++;
+    }
+
+    FindImplEnt ent;
+    ent.rv = this->find_impl__inner(sp, trait_path, trait_params, type, [&](ImplRef impl, bool is_fuzzy)->bool {
+        FindImplCand   c;
+        c.is_fuzzy = is_fuzzy;
+        c.impl = nullptr;
+        c.is_ptr = false;
+        c.has_trait_args = true;
+        TU_MATCH(ImplRef::Data, (impl.m_data), (e),
+        (TraitImpl,
+            c.impl = e.impl;
+            for(const auto* t : e.params) {
+                c.impl_params.push_back( t ? t->clone() : ::HIR::TypeRef() );
+                c.impl_params_set.push_back( t != nullptr );
+            }
+            for(const auto& t : e.params_ph)
+                c.impl_params_ph.push_back( t.clone() );
+            ),
+        (BoundedPtr,
+            c.is_ptr = true;
+            c.type = e.type->clone();
+            c.has_trait_args = (e.trait_args != nullptr);
+            if( e.trait_args )
+                c.trait_args = e.trait_args->clone();
+            for(const auto& a : *e.assoc)
+                c.assoc.insert( ::std::make_pair(a.first, a.second.clone()) );
+            ),
+        (Bounded,
+            c.type = e.type.clone();
+            c.trait_args = e.trait_args.clone();
+            for(const auto& a : e.assoc)
+                c.assoc.insert( ::std::make_pair(a.first, a.second.clone()) );
+            )
+        )
+        auto idx = ent.cands.size();
+        bool rv = (idx < delivered.size() ? delivered[idx] : found_cb(mv$(impl), is_fuzzy));
+        c.cb_rv = rv;
+        ent.cands.push_back( mv$(c) );
+        return rv;
+        }, false);
+    if( delivered.empty() )
+    {
+        m_find_impl_cache.insert( ::std::make_pair(mv$(key), mv$(ent)) );
+    }
+    return ent.rv;
+}
+
+bool StaticTraitResolve::find_impl__inner(
+    const Span& sp,
+    const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+    const ::HIR::TypeRef& type,
+    t_cb_find_impl found_cb,
+    bool dont_handoff_to_specialised
+    ) const
 {
     TRACE_FUNCTION_F(trait_path << FMT_CB(os, if(trait_params) { os << *trait_params; } else { os << "<?>"; }) << " for " << type);
     auto cb_ident = [](const auto&ty)->const auto&{return ty;};
 
-    static ::HIR::PathParams    null_params;
-    static ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
+    static const ::HIR::PathParams    null_params;
+    static const ::std::map< ::std::string, ::HIR::TypeRef>    null_assoc;
 
     if( !dont_handoff_to_specialised ) {
         if( trait_path == m_lang_Copy ) {
@@ -160,7 +343,7 @@ bool StaticTraitResolve::find_impl(
             if( trait_path == mt.m_path ) {
                 if( !trait_params || mt.m_params == *trait_params )
                 {
-                    static ::std::map< ::std::string, ::HIR::TypeRef>  types;
+                    static const ::std::map< ::std::string, ::HIR::TypeRef>  types;
                     return found_cb( ImplRef(&type, &mt.m_params, &types), false );
                 }
             }
@@ -321,7 +504,7 @@ bool StaticTraitResolve::find_impl(
             return rv;
 
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        auto& stack = m_auto_trait_stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait_path )
                 continue ;
@@ -334,9 +517,10 @@ bool StaticTraitResolve::find_impl(
         }
         stack.push_back( ::std::make_tuple( &trait_path, trait_params, &type ) );
         struct Guard {
-            ~Guard() { stack.pop_back(); }
+            decltype(stack)& s;
+            ~Guard() { s.pop_back(); }
         };
-        Guard   _;
+        Guard   _ { stack };
 
         auto cmp = this->check_auto_trait_impl_destructure(sp, trait_path, trait_params, type);
         if( cmp != ::HIR::Compare::Unequal )
@@ -875,6 +1059,43 @@ void StaticTraitResolve::expand_associated_types_inner(const Span& sp, ::HIR::Ty
     )
 }
 void StaticTraitResolve::expand_associated_types__UfcsKnown(const Span& sp, ::HIR::TypeRef& input) const
+{
+    bool has_generics = false;
+    bool cacheable = !visit_ty_with(input, [&](const auto& t) {
+        if( t.m_data.is_Generic() ) {
+            has_generics = true;
+            return false;
+        }
+        return t.m_data.is_Infer() || t.m_data.is_Closure() || t.m_data.is_ErasedType();
+        });
+    if( !has_generics && m_bounds_on_concrete )
+        cacheable = false;
+    if( !cacheable )
+    {
+        this->expand_associated_types__UfcsKnown_inner(sp, input);
+        return ;
+    }
+
+    auto* cache = &m_projection_cache;
+    if( has_generics )
+    {
+        // Projections on generics depend on the bounds, so this cache is cleared when the generics change (see
+        // `prep_indexes` and `NullOnDrop`)
+        cache = &m_projection_cache_generic;
+    }
+    auto it = cache->find(input);
+    if( it != cache->end() )
+    {
+        g_projection_cache_stats_static.hits ++;
+        input = it->second.clone();
+        return ;
+    }
+    g_projection_cache_stats_static.misses ++;
+    auto key = input.clone();
+    this->expand_associated_types__UfcsKnown_inner(sp, input);
+    cache->insert( ::std::make_pair(mv$(key), input.clone()) );
+}
+void StaticTraitResolve::expand_associated_types__UfcsKnown_inner(const Span& sp, ::HIR::TypeRef& input) const
 {
     auto& e = input.m_data.as_Path();
     auto& e2 = e.path.m_data.as_UfcsKnown();
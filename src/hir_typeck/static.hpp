@@ -35,11 +35,57 @@ public:
 private:
     mutable ::std::map< ::HIR::TypeRef, bool >  m_copy_cache;
 
+    /// Memoised `find_impl` query (only for queries without generics)
+    struct FindImplKey
+    {
+        ::HIR::SimplePath   trait;
+        bool    has_params;
+        ::HIR::PathParams   params;
+        ::HIR::TypeRef  type;
+
+        Ordering ord(const FindImplKey& x) const;
+        bool operator<(const FindImplKey& x) const { return ord(x) == OrdLess; }
+    };
+    /// An owned copy of an `ImplRef` passed to the callback, along with the callback's return value
+    struct FindImplCand
+    {
+        bool    is_fuzzy;
+        bool    cb_rv;
+        // TraitImpl
+        const ::HIR::TraitImpl* impl;
+        ::std::vector< ::HIR::TypeRef>  impl_params;
+        ::std::vector<bool> impl_params_set;
+        ::std::vector< ::HIR::TypeRef>  impl_params_ph;
+        // BoundedPtr/Bounded
+        bool    is_ptr;
+        bool    has_trait_args;
+        ::HIR::TypeRef  type;
+        ::HIR::PathParams   trait_args;
+        ::std::map< ::std::string, ::HIR::TypeRef>  assoc;
+    };
+    struct FindImplEnt
+    {
+        ::std::vector<FindImplCand> cands;
+        bool    rv;
+    };
+    /// Cached impl search results, valid for any in-scope generics (see `m_bounds_on_concrete`)
+    mutable ::std::map<FindImplKey, FindImplEnt>    m_find_impl_cache;
+    /// Set by `prep_indexes` if an in-scope bound has a generic-free type (so bounds could change a cached result)
+    bool    m_bounds_on_concrete;
+
+    /// Auto trait queries currently being evaluated (used to detect recursion)
+    mutable ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    m_auto_trait_stack;
+    /// Expansions of generic-free `UfcsKnown` projections (same validity as `m_find_impl_cache`)
+    mutable ::std::map< ::HIR::TypeRef, ::HIR::TypeRef>  m_projection_cache;
+    /// Expansions of projections involving the in-scope generics (cleared whenever the generics change)
+    mutable ::std::map< ::HIR::TypeRef, ::HIR::TypeRef>  m_projection_cache_generic;
+
 public:
     StaticTraitResolve(const ::HIR::Crate& crate):
         m_crate(crate),
         m_impl_generics(nullptr),
-        m_item_generics(nullptr)
+        m_item_generics(nullptr),
+        m_bounds_on_concrete(false)
     {
         m_lang_Copy = m_crate.get_lang_item_path_opt("copy");
         m_lang_Drop = m_crate.get_lang_item_path_opt("drop");
@@ -73,13 +119,17 @@ public:
     /// \{
     template<typename T>
     class NullOnDrop {
+        const StaticTraitResolve& resolve;
         T*& ptr;
     public:
-        NullOnDrop(T*& ptr):
+        NullOnDrop(const StaticTraitResolve& resolve, T*& ptr):
+            resolve(resolve),
             ptr(ptr)
         {}
         ~NullOnDrop() {
             ptr = nullptr;
+            // Cached projections could refer to the generics that just went out of scope
+            resolve.m_projection_cache_generic.clear();
         }
     };
     NullOnDrop< ::HIR::GenericParams> set_impl_generics(::HIR::GenericParams& gps) {
@@ -87,14 +137,14 @@ public:
         m_impl_generics = &gps;
         m_type_equalities.clear();
         prep_indexes();
-        return NullOnDrop< ::HIR::GenericParams>(m_impl_generics);
+        return NullOnDrop< ::HIR::GenericParams>(*this, m_impl_generics);
     }
     NullOnDrop< ::HIR::GenericParams> set_item_generics(::HIR::GenericParams& gps) {
         assert( !m_item_generics );
         m_item_generics = &gps;
         m_type_equalities.clear();
         prep_indexes();
-        return NullOnDrop< ::HIR::GenericParams>(m_item_generics);
+        return NullOnDrop< ::HIR::GenericParams>(*this, m_item_generics);
     }
     /// \}
 
@@ -120,6 +170,19 @@ public:
         ) const;
 
 private:
+    bool find_impl__inner(
+        const Span& sp,
+        const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+        const ::HIR::TypeRef& type,
+        t_cb_find_impl found_cb,
+        bool dont_handoff_to_specialised
+        ) const;
+    bool find_impl__cached(
+        const Span& sp,
+        const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+        const ::HIR::TypeRef& type,
+        t_cb_find_impl found_cb
+        ) const;
     bool find_impl__check_bound(
         const Span& sp,
         const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
@@ -153,6 +216,7 @@ public:
 private:
     void expand_associated_types_inner(const Span& sp, ::HIR::TypeRef& input) const;
     void expand_associated_types__UfcsKnown(const Span& sp, ::HIR::TypeRef& input) const;
+    void expand_associated_types__UfcsKnown_inner(const Span& sp, ::HIR::TypeRef& input) const;
     void replace_equalities(::HIR::TypeRef& input) const;
 
 public:
@@ -9,23 +9,76 @@
 #include <ident.hpp>
 #include <debug.hpp>
 #include <common.hpp>   // vector print
+#include <algorithm>    // std::reverse
+#include <mutex>
 
-unsigned int Ident::Hygiene::g_next_scope = 0;
+namespace {
+    struct HygieneNode {
+        unsigned int    parent;
+        unsigned int    depth;
+    };
+    /// Context tree, indexed by `Hygiene::m_index` (entry 0 is the empty context)
+    ::std::vector<HygieneNode>& hygiene_nodes()
+    {
+        static ::std::vector<HygieneNode>   s_nodes { HygieneNode { 0, 0 } };
+        return s_nodes;
+    }
+    /// Protects the tree while parser worker threads can be adding scopes (additions, and printing for debug output)
+    /// - `is_visible` lookups only happen after parsing is complete, so don't lock
+    ::std::mutex    g_hygiene_lock;
+
+    /// Direct-mapped cache of recent `is_visible` ancestor queries
+    struct VisibilityCacheEnt {
+        unsigned int    des;
+        unsigned int    src;
+        bool    result;
+    };
+    const unsigned int VISIBILITY_CACHE_SIZE = 256;
+    VisibilityCacheEnt  s_visibility_cache[VISIBILITY_CACHE_SIZE];
+}
+
+Ident::Hygiene Ident::Hygiene::new_scope()
+{
+    ::std::lock_guard< ::std::mutex>    lh(g_hygiene_lock);
+    auto& nodes = hygiene_nodes();
+    nodes.push_back( HygieneNode { 0, 1 } );
+    return Hygiene(nodes.size() - 1);
+}
+Ident::Hygiene Ident::Hygiene::new_scope_chained(const Hygiene& parent)
+{
+    ::std::lock_guard< ::std::mutex>    lh(g_hygiene_lock);
+    auto& nodes = hygiene_nodes();
+    auto depth = nodes[parent.m_index].depth + 1;
+    nodes.push_back( HygieneNode { parent.m_index, depth } );
+    return Hygiene(nodes.size() - 1);
+}
 
 bool Ident::Hygiene::is_visible(const Hygiene& src) const
 {
     // HACK: Disable hygiene for now
     //return true;
 
-    if( this->contexts.size() == 0 ) {
-        return src.contexts.size() == 0;
+    if( this->m_index == 0 ) {
+        return src.m_index == 0;
+    }
+    if( this->m_index == src.m_index ) {
+        return true;
     }
 
-    auto des = this->contexts.back();
-    for(const auto& c : src.contexts)
-        if( des == c )
-            return true;
-    return false;
+    // Visible if this context is an ancestor of (i.e. in the chain of) the source context
+    auto& cache_ent = s_visibility_cache[ (this->m_index * 31 + src.m_index) % VISIBILITY_CACHE_SIZE ];
+    if( cache_ent.des == this->m_index && cache_ent.src == src.m_index )
+        return cache_ent.result;
+
+    const auto& nodes = hygiene_nodes();
+    auto des_depth = nodes[this->m_index].depth;
+    auto idx = src.m_index;
+    while( idx != 0 && nodes[idx].depth > des_depth )
+        idx = nodes[idx].parent;
+    bool rv = (idx == this->m_index);
+
+    cache_ent = VisibilityCacheEnt { this->m_index, src.m_index, rv };
+    return rv;
 }
 
 ::std::ostream& operator<<(::std::ostream& os, const Ident& x) {
@@ -34,7 +87,16 @@ bool Ident::Hygiene::is_visible(const Hygiene& src) const
 }
 
 ::std::ostream& operator<<(::std::ostream& os, const Ident::Hygiene& x) {
-    os << "{" << x.contexts << "}";
+    // Reconstruct the chain (root first) for display
+    // - Collected with the lock held, as this is used by debug output while parser workers may be adding scopes
+    ::std::vector<unsigned int> contexts;
+    {
+        ::std::lock_guard< ::std::mutex>    lh(g_hygiene_lock);
+        const auto& nodes = hygiene_nodes();
+        for(auto idx = x.m_index; idx != 0; idx = nodes[idx].parent)
+            contexts.push_back(idx);
+    }
+    ::std::reverse(contexts.begin(), contexts.end());
+    os << "{" << contexts << "}";
     return os;
 }
-
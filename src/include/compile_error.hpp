@@ -3,10 +3,19 @@
 #ifndef _COMPILE_ERROR_H_
 #define _COMPILE_ERROR_H_
 
+#include <iosfwd>
+
 class TokenStream;
 
 namespace CompileError {
 
+/// Stream that error messages are printed to when an error is raised
+/// - `::std::cout`, unless redirected for the current thread (e.g. to only report one of the parser workers' errors)
+/// - While redirected, fatal errors (`ERROR`/`BUG`/`TODO`) throw `Fatal` instead of aborting the process
+extern ::std::ostream& output();
+extern void set_output(::std::ostream* os);
+extern bool output_redirected();
+
 class Base:
     public ::std::exception
 {
@@ -45,6 +54,19 @@ public:
 
 };
 
+/// A fatal error raised while the output was redirected
+/// - Not printed when raised, whoever redirected the output prints `message()` if this is the error it reports
+class Fatal:
+    public Base
+{
+    ::std::string   m_message;
+public:
+    Fatal(::std::string message);
+    virtual ~Fatal() throw ();
+
+    const ::std::string& message() const { return m_message; }
+};
+
 }
 
 #endif
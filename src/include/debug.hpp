@@ -5,7 +5,7 @@
 #include <cassert>
 #include <functional>
 
-extern int g_debug_indent_level;
+extern thread_local int g_debug_indent_level;
 
 #ifndef DISABLE_DEBUG
 # define INDENT()    do { g_debug_indent_level += 1; assert(g_debug_indent_level<300); } while(0)
@@ -24,6 +24,9 @@ extern int g_debug_indent_level;
 #endif
 
 extern bool debug_enabled();
+/// Current compiler phase of this thread (new threads must be given their parent's phase, to get the same debug output)
+extern const ::std::string& debug_get_phase();
+extern void debug_set_phase(const ::std::string& name);
 extern ::std::ostream& debug_output(int indent, const char* function);
 
 struct RepeatLitStr
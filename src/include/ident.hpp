@@ -11,32 +11,25 @@
 
 struct Ident
 {
+    /// Macro hygiene context
+    ///
+    /// Contexts form a parent-linked tree (stored in a global table, see ident.cpp), with each context
+    /// addressed by a single index. A context's chain is the path from its root to itself, so copies are
+    /// trivial and chaining a new scope doesn't copy the parent chain. Index 0 is the empty context.
     class Hygiene
     {
-        static unsigned g_next_scope;
-
-        ::std::vector<unsigned int> contexts;
+        unsigned int    m_index;
 
         Hygiene(unsigned int index):
-            contexts({index})
+            m_index(index)
         {}
     public:
         Hygiene():
-            contexts({})
+            m_index(0)
         {}
 
-        static Hygiene new_scope()
-        {
-            return Hygiene(++g_next_scope);
-        }
-        static Hygiene new_scope_chained(const Hygiene& parent)
-        {
-            Hygiene rv;
-            rv.contexts.reserve( parent.contexts.size() + 1 );
-            rv.contexts.insert( rv.contexts.begin(),  parent.contexts.begin(), parent.contexts.end() );
-            rv.contexts.push_back( ++g_next_scope );
-            return rv;
-        }
+        static Hygiene new_scope();
+        static Hygiene new_scope_chained(const Hygiene& parent);
 
         Hygiene(Hygiene&& x) = default;
         Hygiene(const Hygiene& x) = default;
@@ -45,8 +38,10 @@ struct Ident
 
         // Returns true if an ident with hygine `souce` can see an ident with this hygine
         bool is_visible(const Hygiene& source) const;
-        //bool operator==(const Hygiene& x) const { return scope_index == x.scope_index; }
-        //bool operator!=(const Hygiene& x) const { return scope_index != x.scope_index; }
+        bool operator==(const Hygiene& x) const { return m_index == x.m_index; }
+        bool operator!=(const Hygiene& x) const { return m_index != x.m_index; }
+        /// Hash of the context identity (for caches keyed on hygiene)
+        size_t hash() const { return m_index; }
 
         friend ::std::ostream& operator<<(::std::ostream& os, const Hygiene& v);
     };
@@ -5,6 +5,7 @@
 
 #include <string>
 #include <memory>
+#include <iosfwd>
 
 namespace AST {
     class Crate;
@@ -12,10 +13,17 @@ namespace AST {
 }
 
 /// Parse a crate from the given file
-extern AST::Crate Parse_Crate(::std::string mainfile);
+/// - With more than one thread, out-of-line module files are parsed in parallel
+extern AST::Crate Parse_Crate(::std::string mainfile, unsigned int num_threads);
 
 
 extern void Expand(::AST::Crate& crate);
+/// Print statistics collected during expansion (macro expansion cache)
+extern void Expand_PrintStats(::std::ostream& os);
+/// Enable per-macro profiling of expansion (invocations, recursion depth, token counts, time)
+extern void Expand_EnableProfile();
+/// Print the expansion profile, either as a table sorted by time or as JSON
+extern void Expand_PrintProfile(::std::ostream& os, bool as_json);
 
 /// Process #[] decorators
 extern void Process_Decorators(AST::Crate& crate);
@@ -1,19 +1,42 @@
 /*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/rc_string.hpp
+ * - Reference-counted immutable string
  */
 #pragma once
 
 #include <cstring>
+#include <cstdint>
+#include <string>
+#include <new>
+#include <functional>
 #include <ostream>
 
+/// Immutable reference-counted string
+///
+/// Short strings are stored inline (no allocation), longer strings are shared with an atomic refcount and a
+/// cached hash. Strings created with `new_interned` share storage with all other interned copies, so comparing
+/// two of them is a pointer check.
 class RcString
 {
-    unsigned int*   m_ptr;
+    struct Inner;
+    static const unsigned int INLINE_CAP = sizeof(Inner*);
+
     unsigned int    m_len;
+    union {
+        Inner*  m_ptr;
+        char    m_inline[INLINE_CAP];
+    };
+
+    bool is_inline() const { return m_len < INLINE_CAP; }
 public:
     RcString():
-        m_ptr(nullptr),
         m_len(0)
-    {}
+    {
+        m_inline[0] = '\0';
+    }
     RcString(const char* s, unsigned int len);
     RcString(const char* s):
         RcString(s, ::std::strlen(s))
@@ -23,31 +46,35 @@ public:
         RcString(s.data(), s.size())
     {
     }
+    static RcString new_interned(const char* s, unsigned int len);
+    static RcString new_interned(const ::std::string& s) {
+        return new_interned(s.data(), s.size());
+    }
 
     RcString(const RcString& x):
-        m_ptr(x.m_ptr),
         m_len(x.m_len)
     {
-        if( m_ptr ) *m_ptr += 1;
+        ::std::memcpy(m_inline, x.m_inline, INLINE_CAP);
+        if( !is_inline() ) inc_ref();
     }
     RcString(RcString&& x):
-        m_ptr(x.m_ptr),
         m_len(x.m_len)
     {
-        x.m_ptr = nullptr;
+        ::std::memcpy(m_inline, x.m_inline, INLINE_CAP);
         x.m_len = 0;
+        x.m_inline[0] = '\0';
     }
 
-    ~RcString();
+    ~RcString() {
+        if( !is_inline() ) dec_ref();
+    }
 
     RcString& operator=(const RcString& x)
     {
         if( &x != this )
         {
             this->~RcString();
-            m_ptr = x.m_ptr;
-            m_len = x.m_len;
-            if( m_ptr ) *m_ptr += 1;
+            new (this) RcString(x);
         }
         return *this;
     }
@@ -56,28 +83,32 @@ public:
         if( &x != this )
         {
             this->~RcString();
-            m_ptr = x.m_ptr;
-            m_len = x.m_len;
-            x.m_ptr = nullptr;
-            x.m_len = 0;
+            new (this) RcString(::std::move(x));
         }
         return *this;
     }
 
 
-    const char* c_str() const {
-        if( m_len > 0 )
-        {
-            return reinterpret_cast<const char*>(m_ptr + 1);
-        }
-        else
-        {
-            return "";
-        }
-    }
-    bool operator==(const RcString& s) const { return *this == s.c_str(); }
-    bool operator==(const char* s) const;
+    const char* c_str() const;
+    unsigned int size() const { return m_len; }
+    /// Hash of the string contents (cached for heap strings)
+    size_t hash() const;
+
+    bool operator==(const RcString& s) const;
+    bool operator!=(const RcString& s) const { return !(*this == s); }
+    bool operator==(const char* s) const { return ::std::strcmp(this->c_str(), s) == 0; }
+    bool operator!=(const char* s) const { return !(*this == s); }
     friend ::std::ostream& operator<<(::std::ostream& os, const RcString& x) {
         return os << x.c_str();
     }
+
+private:
+    void inc_ref();
+    void dec_ref();
 };
+
+namespace std {
+    template<> struct hash<RcString> {
+        size_t operator()(const RcString& s) const { return s.hash(); }
+    };
+}
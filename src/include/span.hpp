@@ -9,6 +9,7 @@
 
 #include <rc_string.hpp>
 #include <functional>
+#include <cstdint>
 
 enum ErrorType
 {
@@ -23,31 +24,37 @@ class Position;
 
 struct ProtoSpan
 {
-    RcString   filename;
+    uint32_t    file;
 
     unsigned int start_line;
     unsigned int start_ofs;
 };
+/// Compact source location
+///
+/// A span is a 32-bit handle into the global source map (see span.cpp), which stores the file table and the
+/// line/column ranges. This keeps spans trivially copyable (no refcount traffic), with the location only
+/// resolved when a diagnostic or dump needs it. Handle 0 is the empty span.
 struct Span
 {
-    RcString    filename;
+    uint32_t    m_idx;
 
-    unsigned int start_line;
-    unsigned int start_ofs;
-    unsigned int end_line;
-    unsigned int end_ofs;
-
-    Span(RcString filename, unsigned int start_line, unsigned int start_ofs,  unsigned int end_line, unsigned int end_ofs):
-        filename( ::std::move(filename) ),
-        start_line(start_line),
-        start_ofs(start_ofs),
-        end_line(end_line),
-        end_ofs(end_ofs)
-    {}
-    Span(const Span& x);
+    Span(RcString filename, unsigned int start_line, unsigned int start_ofs,  unsigned int end_line, unsigned int end_ofs);
+    Span(uint32_t file, unsigned int start_line, unsigned int start_ofs,  unsigned int end_line, unsigned int end_ofs);
+    Span(const Span& x) = default;
+    Span& operator=(const Span& x) = default;
     Span(const Position& position);
     Span();
 
+    /// Look up (or add) a file in the source map's file table, returning its index
+    static uint32_t intern_file(const RcString& filename);
+    static const RcString& file_name(uint32_t file);
+
+    const RcString& filename() const;
+    unsigned int start_line() const;
+    unsigned int start_ofs() const;
+    unsigned int end_line() const;
+    unsigned int end_ofs() const;
+
     void bug(::std::function<void(::std::ostream&)> msg) const;
     void error(ErrorType tag, ::std::function<void(::std::ostream&)> msg) const;
     void warning(WarningType tag, ::std::function<void(::std::ostream&)> msg) const;
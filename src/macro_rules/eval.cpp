@@ -14,6 +14,7 @@
 #include "pattern_checks.hpp"
 #include <parse/interpolated_fragment.hpp>
 #include <ast/expr.hpp>
+#include <unordered_map>
 
 class ParameterMappings
 {
@@ -563,7 +564,7 @@ public:
     // - NOTE: When a Loop entry is returned, the separator token should be emitted
     const MacroExpansionEnt* next_ent();
 
-    const ::std::vector<unsigned int>   iterations() const { return m_iterations; }
+    const ::std::vector<unsigned int>& iterations() const { return m_iterations; }
     unsigned int top_pos() const { return m_offsets[0].read_pos; }
 
 private:
@@ -574,7 +575,7 @@ private:
 class MacroExpander:
     public TokenStream
 {
-    const RcString  m_macro_filename;
+    const uint32_t  m_macro_file;
 
     const ::std::string m_crate_name;
 
@@ -582,14 +583,15 @@ class MacroExpander:
     MacroExpandState    m_state;
 
     Token   m_next_token;   // used for inserting a single token into the stream
-    ::std::unique_ptr<TTStreamO> m_ttstream;
+    /// Stream for a captured `tt` - borrows from `m_mappings` unless this was the capture's last use
+    ::std::unique_ptr<TokenStream> m_ttstream;
     Ident::Hygiene  m_hygiene;
 
 public:
     MacroExpander(const MacroExpander& x) = delete;
 
     MacroExpander(const ::std::string& macro_name, const Ident::Hygiene& parent_hygiene, const ::std::vector<MacroExpansionEnt>& contents, ParameterMappings mappings, ::std::string crate_name):
-        m_macro_filename( FMT("Macro:" << macro_name) ),
+        m_macro_file( Span::intern_file(FMT("Macro:" << macro_name)) ),
         m_crate_name( mv$(crate_name) ),
         m_mappings( mv$(mappings) ),
         m_state( contents, m_mappings ),
@@ -600,6 +602,9 @@ public:
     Position getPosition() const override;
     Ident::Hygiene realGetHygiene() const override;
     Token realGetToken() override;
+
+    /// Hygiene context given to tokens from the macro body
+    const Ident::Hygiene& expansion_hygiene() const { return m_hygiene; }
 };
 
 void Macro_InitDefaults()
@@ -721,11 +726,323 @@ InterpolatedFragment Macro_HandlePatternCap(TokenStream& lex, MacroPatEnt::Type
     throw "";
 }
 
+namespace {
+    /// Collect the token types that can start a pattern sequence into `toks` (setting `any` if a capture can start
+    /// it), returning true if the sequence can match nothing.
+    bool get_first_toks(const ::std::vector<MacroPatEnt>& pats, ::std::set<eTokenType>& toks, bool& any)
+    {
+        for(const auto& pat : pats)
+        {
+            switch(pat.type)
+            {
+            case MacroPatEnt::PAT_TOKEN:
+                toks.insert( pat.tok.type() );
+                return false;
+            case MacroPatEnt::PAT_LOOP:
+                // A `+` loop must be entered, so only continue if its body can be empty
+                if( !get_first_toks(pat.subpats, toks, any) && pat.name == "+" )
+                    return false;
+                break;
+            default:
+                any = true;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void MacroRules::build_matcher()
+{
+    TRACE_FUNCTION;
+    m_matcher = MacroRulesMatcher();
+
+    ::std::vector< ::std::set<eTokenType> > arm_toks( m_rules.size() );
+    ::std::vector<bool> arm_any( m_rules.size() );
+    unsigned int max_tok = 0;
+    for(unsigned int i = 0; i < m_rules.size(); i ++)
+    {
+        bool any = false;
+        if( get_first_toks(m_rules[i].m_pattern, arm_toks[i], any) )
+            arm_toks[i].insert( TOK_EOF );
+        arm_any[i] = any;
+        for(auto t : arm_toks[i])
+            max_tok = ::std::max(max_tok, static_cast<unsigned int>(t));
+    }
+
+    m_matcher.m_arms_by_tok.resize( max_tok + 1 );
+    for(unsigned int i = 0; i < m_rules.size(); i ++)
+    {
+        if( arm_any[i] )
+        {
+            m_matcher.m_any_arms.push_back(i);
+            for(auto& list : m_matcher.m_arms_by_tok)
+                list.push_back(i);
+        }
+        else
+        {
+            for(auto t : arm_toks[i])
+                m_matcher.m_arms_by_tok[t].push_back(i);
+        }
+    }
+}
+
+// ----------------------------------------------------------------
+// Expansion cache
+// ----------------------------------------------------------------
+namespace {
+    /// Recorded output of a single macro_rules! expansion
+    struct CachedExpansion
+    {
+        // - Key (see `macro_identity_matches`)
+        unsigned int    def_index;
+        AST::Path   mod_path;
+        ::std::string   name;
+        TokenTree   input;
+
+        struct Ent {
+            Token   tok;
+            Ident::Hygiene  hygiene;
+            Position    pos;
+
+            Ent(Token tok, Ident::Hygiene hygiene, Position pos):
+                tok(mv$(tok)), hygiene(mv$(hygiene)), pos(mv$(pos))
+            {}
+            // NOTE: Token's copy constructor can't handle fragments, so force moves when the vector grows
+            Ent(const Ent&) = delete;
+            Ent(Ent&&) = default;
+        };
+        ::std::vector<Ent>  output;
+        /// Context used for tokens from the macro body, replaced by a fresh one on replay
+        Ident::Hygiene  body_hygiene;
+    };
+
+    /// Cache of expansions, keyed on macro + invoking module + a hash of the input token tree
+    /// - Macros are identified by `MacroRules::m_def_index` and modules by path (not address), as an address can be
+    ///   reused by a later definition once the original is freed.
+    struct ExpansionCache
+    {
+        /// Limit on the number of stored expansions (after this, only lookups happen)
+        static const size_t MAX_ENTRIES = 1 << 16;
+
+        ::std::unordered_multimap<size_t, ::std::shared_ptr<const CachedExpansion>>    m_ents;
+
+        unsigned int    m_hits = 0;
+        unsigned int    m_misses = 0;
+        unsigned int    m_uncacheable = 0;
+    };
+    ExpansionCache  g_expansion_cache;
+
+    void hash_mix(size_t& h, size_t v)
+    {
+        h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    /// Hash of the macro identity: the definition's unique index, and the invoking module's path
+    /// - The definition location isn't enough: macros generated by another macro all get the generating invocation's span
+    size_t hash_macro_identity(const MacroRules& rules, const AST::Module& mod)
+    {
+        size_t  h = rules.m_def_index;
+        for(const auto& node : mod.path().nodes())
+            hash_mix( h, ::std::hash< ::std::string>()(node.name()) );
+        return h;
+    }
+    bool macro_identity_matches(const CachedExpansion& ent, const MacroRules& rules, const AST::Module& mod)
+    {
+        return ent.def_index == rules.m_def_index
+            && ent.mod_path == mod.path();
+    }
+
+    bool is_fragment_token(eTokenType ty)
+    {
+        return TOK_INTERPOLATED_IDENT <= ty && ty <= TOK_INTERPOLATED_ITEM;
+    }
+
+    /// Hash a token tree (including hygiene), returns false if the tree contains a fragment (can't be hashed/compared)
+    bool hash_tt(const TokenTree& tt, size_t& h)
+    {
+        auto mix = [&](size_t v) { hash_mix(h, v); };
+        mix( tt.hygiene().hash() );
+        if( tt.size() == 0 )
+        {
+            const auto& tok = tt.tok();
+            if( is_fragment_token(tok.type()) )
+                return false;
+            mix( tok.type() );
+            switch(tok.type())
+            {
+            case TOK_IDENT:
+            case TOK_MACRO:
+            case TOK_LIFETIME:
+            case TOK_STRING:
+            case TOK_BYTESTRING:
+                mix( tok.istr().hash() );
+                break;
+            case TOK_INTEGER:
+                mix( tok.intval() );
+                break;
+            default:
+                break;
+            }
+            return true;
+        }
+        else
+        {
+            mix( tt.size() );
+            for(unsigned int i = 0; i < tt.size(); i ++)
+            {
+                if( !hash_tt(tt[i], h) )
+                    return false;
+            }
+            return true;
+        }
+    }
+    /// Exact comparison of two (fragment-free) token trees
+    bool equal_tt(const TokenTree& a, const TokenTree& b)
+    {
+        if( a.hygiene() != b.hygiene() )
+            return false;
+        if( a.size() != b.size() )
+            return false;
+        if( a.size() == 0 )
+            return a.tok() == b.tok();
+        for(unsigned int i = 0; i < a.size(); i ++)
+        {
+            if( !equal_tt(a[i], b[i]) )
+                return false;
+        }
+        return true;
+    }
+
+    /// Replays a cached expansion, with a fresh hygiene context in place of the recorded one
+    class MacroReplayStream:
+        public TokenStream
+    {
+        ::std::shared_ptr<const CachedExpansion>    m_ent;
+        size_t  m_idx;
+        Ident::Hygiene  m_hygiene;
+        Ident::Hygiene  m_last_hygiene;
+        Position    m_last_pos;
+    public:
+        MacroReplayStream(::std::shared_ptr<const CachedExpansion> ent, Ident::Hygiene hygiene):
+            m_ent( mv$(ent) ),
+            m_idx(0),
+            m_hygiene( mv$(hygiene) ),
+            m_last_hygiene( m_hygiene )
+        {
+        }
+
+        Position getPosition() const override {
+            return m_last_pos;
+        }
+        Ident::Hygiene realGetHygiene() const override {
+            return m_last_hygiene;
+        }
+        Token realGetToken() override {
+            if( m_idx == m_ent->output.size() )
+                return Token(TOK_EOF);
+            const auto& e = m_ent->output[m_idx++];
+            m_last_hygiene = (e.hygiene == m_ent->body_hygiene ? m_hygiene : e.hygiene);
+            m_last_pos = e.pos;
+            return e.tok.clone();
+        }
+    };
+
+    /// Passes through tokens from a MacroExpander, recording them into the cache once the end is reached
+    class MacroRecordStream:
+        public TokenStream
+    {
+        ::std::unique_ptr<MacroExpander>    m_inner;
+        size_t  m_key;
+        ::std::shared_ptr<CachedExpansion>  m_ent;  // Cleared if the output can't be cached
+    public:
+        MacroRecordStream(::std::unique_ptr<MacroExpander> inner, size_t key, ::std::shared_ptr<CachedExpansion> ent):
+            m_inner( mv$(inner) ),
+            m_key(key),
+            m_ent( mv$(ent) )
+        {
+            m_ent->body_hygiene = m_inner->expansion_hygiene();
+        }
+
+        Position getPosition() const override {
+            return m_inner->getPosition();
+        }
+        Ident::Hygiene realGetHygiene() const override {
+            return m_inner->getHygiene();
+        }
+        Token realGetToken() override {
+            auto tok = m_inner->getToken();
+            if( m_ent )
+            {
+                if( tok.type() == TOK_EOF )
+                {
+                    g_expansion_cache.m_ents.insert( ::std::make_pair(m_key, mv$(m_ent)) );
+                    m_ent.reset();
+                }
+                else if( tok.type() == TOK_INTERPOLATED_ITEM )
+                {
+                    // Items can't be cloned
+                    g_expansion_cache.m_uncacheable += 1;
+                    m_ent.reset();
+                }
+                else
+                {
+                    // Record the expander's position (not the token's), so a replay reports the same location
+                    m_ent->output.push_back( CachedExpansion::Ent( tok.clone(), m_inner->getHygiene(), m_inner->getPosition() ) );
+                }
+            }
+            return tok;
+        }
+    };
+}
+
+void Macro_InvokeRules_PrintStats(::std::ostream& os)
+{
+    const auto& c = g_expansion_cache;
+    os << "macro_rules! expansion cache: "
+        << c.m_hits << " hits, " << c.m_misses << " misses, " << c.m_uncacheable << " uncacheable"
+        << " (" << c.m_ents.size() << " entries)"
+        << ::std::endl;
+}
+
 /// Parse the input TokenTree according to the `macro_rules!` patterns and return a token stream of the replacement
 ::std::unique_ptr<TokenStream> Macro_InvokeRules(const char *name, const MacroRules& rules, TokenTree input, AST::Module& mod)
 {
     TRACE_FUNCTION_F("'" << name << "', " << input);
 
+    // Check for a previous identical invocation
+    size_t  cache_key = hash_macro_identity(rules, mod);
+    bool can_cache = hash_tt(input, cache_key);
+    if( can_cache )
+    {
+        auto range = g_expansion_cache.m_ents.equal_range(cache_key);
+        for(auto it = range.first; it != range.second; ++ it)
+        {
+            const auto& ent = *it->second;
+            if( macro_identity_matches(ent, rules, mod) && ent.name == name && equal_tt(ent.input, input) )
+            {
+                DEBUG("Cache hit - " << ent.output.size() << " tokens");
+                g_expansion_cache.m_hits += 1;
+                return ::std::unique_ptr<TokenStream>( new MacroReplayStream(it->second, Ident::Hygiene::new_scope_chained(rules.m_hygiene)) );
+            }
+        }
+        g_expansion_cache.m_misses += 1;
+        if( g_expansion_cache.m_ents.size() >= ExpansionCache::MAX_ENTRIES )
+            can_cache = false;
+    }
+    else
+    {
+        g_expansion_cache.m_uncacheable += 1;
+    }
+    ::std::shared_ptr<CachedExpansion>  cache_ent;
+    if( can_cache )
+    {
+        cache_ent = ::std::make_shared<CachedExpansion>();
+        cache_ent->def_index = rules.m_def_index;
+        cache_ent->mod_path = AST::Path(mod.path());
+        cache_ent->name = name;
+        cache_ent->input = input.clone();
+    }
+
     ParameterMappings   bound_tts;
     unsigned int    rule_index = Macro_InvokeRules_MatchPattern(rules, mv$(input), mod,  bound_tts);
 
@@ -741,9 +1058,13 @@ InterpolatedFragment Macro_HandlePatternCap(TokenStream& lex, MacroPatEnt::Type
     // Run through the expansion counting the number of times each fragment is used
     Macro_InvokeRules_CountSubstUses(bound_tts, rule.m_contents);
 
-    TokenStream* ret_ptr = new MacroExpander(name, rules.m_hygiene, rule.m_contents, mv$(bound_tts), rules.m_source_crate);
+    ::std::unique_ptr<MacroExpander> ret_ptr { new MacroExpander(name, rules.m_hygiene, rule.m_contents, mv$(bound_tts), rules.m_source_crate) };
+    if( cache_ent )
+    {
+        return ::std::unique_ptr<TokenStream>( new MacroRecordStream(mv$(ret_ptr), cache_key, mv$(cache_ent)) );
+    }
 
-    return ::std::unique_ptr<TokenStream>( ret_ptr );
+    return ::std::unique_ptr<TokenStream>( mv$(ret_ptr) );
 }
 
 unsigned int Macro_InvokeRules_MatchPattern(const MacroRules& rules, TokenTree input, AST::Module& mod,  ParameterMappings& bound_tts)
@@ -761,24 +1082,43 @@ unsigned int Macro_InvokeRules_MatchPattern(const MacroRules& rules, TokenTree i
         ::std::vector<Capture>  captures;
         MacroPatternStream  stream;
     };
+    TTStreamO   lex( mv$(input) );
+    SET_MODULE(lex, mod);
+
     // - List of active rules (rules that haven't yet failed)
+    // > Start with only the arms that can begin with the first input token (if no arms can, use them all so the
+    //   error is reported by the matcher below)
     ::std::vector< ActiveArm > active_arms;
-    active_arms.reserve( rules.m_rules.size() );
-    for(unsigned int i = 0; i < rules.m_rules.size(); i ++)
+    const auto& first_arms = rules.m_matcher.arms_for( lex.lookahead(0) );
+    if( rules.m_matcher.m_arms_by_tok.size() > 0 && first_arms.size() > 0 )
     {
-        active_arms.push_back( ActiveArm { i, {}, MacroPatternStream(rules.m_rules[i].m_pattern) } );
+        DEBUG("Arms for " << Token::typestr(lex.lookahead(0)) << ": " << first_arms.size() << "/" << rules.m_rules.size());
+        active_arms.reserve( first_arms.size() );
+        for(auto i : first_arms)
+        {
+            active_arms.push_back( ActiveArm { i, {}, MacroPatternStream(rules.m_rules[i].m_pattern) } );
+        }
+    }
+    else
+    {
+        active_arms.reserve( rules.m_rules.size() );
+        for(unsigned int i = 0; i < rules.m_rules.size(); i ++)
+        {
+            active_arms.push_back( ActiveArm { i, {}, MacroPatternStream(rules.m_rules[i].m_pattern) } );
+        }
     }
 
     // - List of captured values
     ::std::vector<InterpolatedFragment> captures;
 
-    TTStreamO   lex( mv$(input) );
-    SET_MODULE(lex, mod);
+    // - Concrete patterns for the current step (one per active arm), reused between steps
+    ::std::vector<SimplePatEnt> arm_pats;
+    arm_pats.reserve( active_arms.size() );
     while(true)
     {
         DEBUG("--- ---");
         // 1. Get concrete patterns for all active rules (i.e. no If* patterns)
-        ::std::vector<SimplePatEnt> arm_pats;
+        arm_pats.clear();
         for(auto& arm : active_arms)
         {
             auto idx = arm.index;
@@ -1065,8 +1405,15 @@ void Macro_InvokeRules_CountSubstUses(ParameterMappings& bound_tts, const ::std:
 
 Position MacroExpander::getPosition() const
 {
+    // Tokens from a substituted capture report where they were written (in the invocation)
+    if( m_ttstream )
+    {
+        auto rv = m_ttstream->getPosition();
+        if( rv.file != 0 )
+            return rv;
+    }
     // TODO: Return a far better span - invocaion location?
-    return Position(m_macro_filename, 0, m_state.top_pos());
+    return Position(m_macro_file, 0, m_state.top_pos());
 }
 Ident::Hygiene MacroExpander::realGetHygiene() const
 {
@@ -1136,7 +1483,10 @@ Token MacroExpander::realGetToken()
                     }
                     else
                     {
-                        m_ttstream.reset( new TTStreamO( frag->as_tt().clone() ) );
+                        // Still used later, stream directly from the captured tree instead of cloning it.
+                        // - `m_mappings` outlives `m_ttstream`, and isn't touched until this stream is exhausted
+                        // - Each token handed out shares its string payload with the captured one (no string copies)
+                        m_ttstream.reset( new TTStream( frag->as_tt() ) );
                     }
                     return m_ttstream->getToken();
                 }
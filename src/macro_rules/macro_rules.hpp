@@ -130,6 +130,23 @@ struct MacroRulesArm:
     SERIALISABLE_PROTOTYPES();
 };
 
+/// Precomputed arm selection for a `macro_rules!` block
+///
+/// Maps the type of the first input token to the arms that could possibly start with it, so an invocation only runs
+/// the full matcher over plausible arms. Built when the macro is defined or loaded (see `MacroRules::build_matcher`)
+struct MacroRulesMatcher
+{
+    /// Arms that can start with any token (e.g. a leading capture), used for token types past the end of the table
+    ::std::vector<unsigned int> m_any_arms;
+    /// Arms that can start with each token type (including `m_any_arms`), indexed by `eTokenType`
+    ::std::vector< ::std::vector<unsigned int> >  m_arms_by_tok;
+
+    const ::std::vector<unsigned int>& arms_for(eTokenType ty) const {
+        auto idx = static_cast<unsigned int>(ty);
+        return idx < m_arms_by_tok.size() ? m_arms_by_tok[idx] : m_any_arms;
+    }
+};
+
 /// A sigle 'macro_rules!' block
 class MacroRules:
     public Serialisable
@@ -141,22 +158,31 @@ public:
     /// Crate that defined this macro
     /// - Populated on deserialise if not already set
     ::std::string   m_source_crate;
+    /// Unique index of this definition (not serialised, assigned on construction)
+    /// - Distinguishes definitions that share a location, e.g. several generated by the same macro invocation.
+    unsigned int    m_def_index;
 
     Ident::Hygiene  m_hygiene;
 
     /// Expansion rules
     ::std::vector<MacroRulesArm>  m_rules;
 
-    MacroRules()
-    {
-    }
+    /// Arm selection table (not serialised, rebuilt on load)
+    MacroRulesMatcher   m_matcher;
+
+    MacroRules();
     virtual ~MacroRules();
     MacroRules(MacroRules&&) = default;
 
+    /// Populate `m_matcher` from the arm patterns
+    void build_matcher();
+
     SERIALISABLE_PROTOTYPES();
 };
 
 extern ::std::unique_ptr<TokenStream>   Macro_InvokeRules(const char *name, const MacroRules& rules, TokenTree input, AST::Module& mod);
+/// Print macro_rules! expansion cache statistics
+extern void Macro_InvokeRules_PrintStats(::std::ostream& os);
 extern MacroRulesPtr    Parse_MacroRules(TokenStream& lex);
 
 #endif // MACROS_HPP_INCLUDED
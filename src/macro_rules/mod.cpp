@@ -6,6 +6,7 @@
 #include <parse/tokentree.hpp>
 #include <parse/common.hpp>
 #include <limits.h>
+#include <atomic>
 
 #include "pattern_checks.hpp"
 
@@ -293,6 +294,12 @@ SERIALISE_TU(MacroExpansionEnt, "MacroExpansionEnt", e,
     return os;
 }
 
+MacroRules::MacroRules()
+{
+    // Definitions are created by parser worker threads, so use an atomic counter
+    static ::std::atomic<unsigned int>  s_next_def_index { 0 };
+    m_def_index = s_next_def_index.fetch_add(1, ::std::memory_order_relaxed);
+}
 MacroRules::~MacroRules()
 {
 }
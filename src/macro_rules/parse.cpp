@@ -476,6 +476,7 @@ MacroRulesPtr Parse_MacroRules(TokenStream& lex)
     auto rv = new MacroRules( );
     rv->m_hygiene = lex.getHygiene();
     rv->m_rules = mv$(rule_arms);
+    rv->build_matcher();
 
     return MacroRulesPtr(rv);
 }
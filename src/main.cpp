@@ -7,8 +7,10 @@
  */
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <string>
 #include <set>
+#include <mutex>
 #include "parse/lex.hpp"
 #include "parse/parseerror.hpp"
 #include "ast/ast.hpp"
@@ -26,9 +28,10 @@
 
 #include "expand/cfg.hpp"
 
-int g_debug_indent_level = 0;
-bool g_debug_enabled = true;
-::std::string g_cur_phase;
+thread_local int g_debug_indent_level = 0;
+// NOTE: Per-thread, worker threads are started in their parent's phase (see `debug_set_phase`)
+thread_local bool g_debug_enabled = true;
+thread_local ::std::string g_cur_phase;
 ::std::set< ::std::string>    g_debug_disable_map;
 
 void init_debug_list()
@@ -52,6 +55,7 @@ void init_debug_list()
     g_debug_disable_map.insert( "Typecheck Outer");
     g_debug_disable_map.insert( "Typecheck Expressions" );
 
+    g_debug_disable_map.insert( "Expand HIR Bodies" );
     g_debug_disable_map.insert( "Expand HIR Annotate" );
     g_debug_disable_map.insert( "Expand HIR Closures" );
     g_debug_disable_map.insert( "Expand HIR Calls" );
@@ -106,9 +110,37 @@ bool debug_enabled()
 {
     return g_debug_enabled;
 }
+const ::std::string& debug_get_phase()
+{
+    return g_cur_phase;
+}
+void debug_set_phase(const ::std::string& name)
+{
+    g_cur_phase = name;
+    g_debug_enabled = debug_enabled_update();
+}
+namespace {
+    /// Per-thread debug output buffer, written to stdout a whole line at a time (so output from worker threads doesn't interleave)
+    class DebugLineBuf:
+        public ::std::stringbuf
+    {
+        static ::std::mutex s_lock;
+    protected:
+        int sync() override {
+            ::std::lock_guard< ::std::mutex>    lh { s_lock };
+            ::std::cout << this->str();
+            ::std::cout.flush();
+            this->str("");
+            return 0;
+        }
+    };
+    ::std::mutex DebugLineBuf::s_lock;
+}
 ::std::ostream& debug_output(int indent, const char* function)
 {
-    return ::std::cout << g_cur_phase << "- " << RepeatLitStr { " ", indent } << function << ": ";
+    thread_local DebugLineBuf   buf;
+    thread_local ::std::ostream  os(&buf);
+    return os << g_cur_phase << "- " << RepeatLitStr { " ", indent } << function << ": ";
 }
 
 struct ProgramParams
@@ -133,6 +165,23 @@ struct ProgramParams
 
     unsigned opt_level = 0;
     bool emit_debug_info = false;
+    /// Number of worker threads for passes that can run in parallel (1 = run everything on the main thread)
+    unsigned num_threads = 1;
+    /// Print statistics (e.g. cache hit rates) collected by each pass
+    bool print_stats = false;
+    /// Profile macro expansion (table printed after expand)
+    bool expand_profile = false;
+    /// If non-empty, the expansion profile is written to this file as JSON
+    ::std::string   expand_profile_json;
+    /// Collect typecheck solver statistics (summary printed after typecheck)
+    bool typeck_stats = false;
+    /// Warn about bodies that take at least this many milliseconds/solver passes to typecheck (0 = no limit)
+    unsigned typeck_warn_ms = 0;
+    unsigned typeck_warn_passes = 0;
+    /// Dump the outstanding typecheck rules of a body that reaches the pass limit
+    bool typeck_dump_stalled = false;
+    /// Run the HIR expansion passes one at a time instead of as a single traversal (for debugging each pass)
+    bool separate_expand = false;
 
     ::std::vector<const char*> lib_search_dirs;
     ::std::vector<const char*> libraries;
@@ -145,13 +194,11 @@ struct ProgramParams
 template <typename Rv, typename Fcn>
 Rv CompilePhase(const char *name, Fcn f) {
     ::std::cout << name << ": V V V" << ::std::endl;
-    g_cur_phase = name;
-    g_debug_enabled = debug_enabled_update();
+    debug_set_phase(name);
     auto start = clock();
     auto rv = f();
     auto end = clock();
-    g_cur_phase = "";
-    g_debug_enabled = debug_enabled_update();
+    debug_set_phase("");
 
     ::std::cout <<"(" << ::std::fixed << ::std::setprecision(2) << static_cast<double>(end - start) / static_cast<double>(CLOCKS_PER_SEC) << " s) ";
     ::std::cout << name << ": DONE";
@@ -197,7 +244,7 @@ int main(int argc, char *argv[])
     {
         // Parse the crate into AST
         AST::Crate crate = CompilePhase<AST::Crate>("Parse", [&]() {
-            return Parse_Crate(params.infile);
+            return Parse_Crate(params.infile, params.num_threads);
             });
 
         if( params.last_stage == ProgramParams::STAGE_PARSE ) {
@@ -210,9 +257,24 @@ int main(int argc, char *argv[])
             });
 
         // Iterate all items in the AST, applying syntax extensions
+        if( params.expand_profile ) {
+            Expand_EnableProfile();
+        }
         CompilePhaseV("Expand", [&]() {
             Expand(crate);
             });
+        if( params.expand_profile ) {
+            if( params.expand_profile_json != "" ) {
+                ::std::ofstream os(params.expand_profile_json);
+                Expand_PrintProfile(os, true);
+            }
+            else {
+                Expand_PrintProfile(::std::cout, false);
+            }
+        }
+        if( params.print_stats ) {
+            Expand_PrintStats(::std::cout);
+        }
 
         // Extract the crate type and name from the crate attributes
         auto crate_type = params.crate_type;
@@ -361,27 +423,46 @@ int main(int argc, char *argv[])
             Typecheck_ModuleLevel(*hir_crate);
             });
         // Check the rest of the expressions (including function bodies)
+        if( params.typeck_stats ) {
+            Typecheck_EnableSolverStats(params.typeck_warn_ms, params.typeck_warn_passes, params.typeck_dump_stalled);
+        }
         CompilePhaseV("Typecheck Expressions", [&]() {
             Typecheck_Expressions(*hir_crate);
             });
+        if( params.typeck_stats ) {
+            Typecheck_PrintSolverStats(::std::cout);
+        }
         // === HIR Expansion ===
-        // Annotate how each node's result is used
-        CompilePhaseV("Expand HIR Annotate", [&]() {
-            HIR_Expand_AnnotateUsage(*hir_crate);
-            });
-        // - Now that all types are known, closures can be desugared
-        CompilePhaseV("Expand HIR Closures", [&]() {
-            HIR_Expand_Closures(*hir_crate);
-            });
-        // - Construct VTables for all traits and impls.
-        CompilePhaseV("Expand HIR VTables", [&]() { HIR_Expand_VTables(*hir_crate); });
-        // - And calls can be turned into UFCS
-        CompilePhaseV("Expand HIR Calls", [&]() {
-            HIR_Expand_UfcsEverything(*hir_crate);
-            });
-        CompilePhaseV("Expand HIR Reborrows", [&]() {
-            HIR_Expand_Reborrows(*hir_crate);
-            });
+        if( params.separate_expand )
+        {
+            // Annotate how each node's result is used
+            CompilePhaseV("Expand HIR Annotate", [&]() {
+                HIR_Expand_AnnotateUsage(*hir_crate, params.num_threads);
+                });
+            // - Now that all types are known, closures can be desugared
+            CompilePhaseV("Expand HIR Closures", [&]() {
+                HIR_Expand_Closures(*hir_crate, params.num_threads);
+                });
+            // - Construct VTables for all traits and impls.
+            CompilePhaseV("Expand HIR VTables", [&]() { HIR_Expand_VTables(*hir_crate); });
+            // - And calls can be turned into UFCS
+            CompilePhaseV("Expand HIR Calls", [&]() {
+                HIR_Expand_UfcsEverything(*hir_crate, params.num_threads);
+                });
+            CompilePhaseV("Expand HIR Reborrows", [&]() {
+                HIR_Expand_Reborrows(*hir_crate, params.num_threads);
+                });
+        }
+        else
+        {
+            // Annotate, Closures, Calls and Reborrows in one walk of each body
+            CompilePhaseV("Expand HIR Bodies", [&]() {
+                HIR_Expand_Fused(*hir_crate, params.num_threads);
+                });
+            // - VTables only touches traits (so can run after calls/reborrows), but must see the closure impls
+            CompilePhaseV("Expand HIR VTables", [&]() { HIR_Expand_VTables(*hir_crate); });
+        }
+        // - ErasedType reads other functions' bodies, so has to wait for all of them to be expanded
         CompilePhaseV("Expand HIR ErasedType", [&]() {
             HIR_Expand_ErasedType(*hir_crate);
             });
@@ -504,6 +585,10 @@ int main(int argc, char *argv[])
             // - Invoke linker?
             break;
         }
+
+        if( params.print_stats ) {
+            Typecheck_PrintStats(::std::cout);
+        }
     }
     catch(unsigned int) {}
     //catch(const CompileError::Base& e)
@@ -662,6 +747,58 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     Cfg_SetFlag(opt_and_val);
                 }
             }
+            else if( strcmp(arg, "--stats") == 0 ) {
+                this->print_stats = true;
+            }
+            else if( strcmp(arg, "--expand-profile") == 0 ) {
+                this->expand_profile = true;
+            }
+            else if( strcmp(arg, "--expand-profile-json") == 0 ) {
+                if( i == argc - 1 ) {
+                    ::std::cerr << "Flag --expand-profile-json requires an argument" << ::std::endl;
+                    exit(1);
+                }
+                this->expand_profile = true;
+                this->expand_profile_json = argv[++i];
+            }
+            else if( strcmp(arg, "--typeck-stats") == 0 ) {
+                this->typeck_stats = true;
+            }
+            else if( strcmp(arg, "--typeck-warn-ms") == 0 || strcmp(arg, "--typeck-warn-passes") == 0 ) {
+                if( i == argc - 1 ) {
+                    ::std::cerr << "Flag " << arg << " requires an argument" << ::std::endl;
+                    exit(1);
+                }
+                int n = atoi(argv[++i]);
+                if( n <= 0 ) {
+                    ::std::cerr << "Invalid value for " << arg << ::std::endl;
+                    exit(1);
+                }
+                if( strcmp(arg, "--typeck-warn-ms") == 0 )
+                    this->typeck_warn_ms = n;
+                else
+                    this->typeck_warn_passes = n;
+                this->typeck_stats = true;
+            }
+            else if( strcmp(arg, "--typeck-dump-stalled") == 0 ) {
+                this->typeck_dump_stalled = true;
+                this->typeck_stats = true;
+            }
+            else if( strcmp(arg, "--no-fused-expand") == 0 ) {
+                this->separate_expand = true;
+            }
+            else if( strcmp(arg, "--threads") == 0 ) {
+                if( i == argc - 1 ) {
+                    ::std::cerr << "Flag --threads requires an argument" << ::std::endl;
+                    exit(1);
+                }
+                int n = atoi(argv[++i]);
+                if( n <= 0 ) {
+                    ::std::cerr << "Invalid value for --threads" << ::std::endl;
+                    exit(1);
+                }
+                this->num_threads = n;
+            }
             else if( strcmp(arg, "--stop-after") == 0 ) {
                 if( i == argc - 1 ) {
                     ::std::cerr << "Flag --stop-after requires an argument" << ::std::endl;
@@ -52,6 +52,12 @@ extern ::AST::Named<::AST::Item> Parse_Mod_Item_S(TokenStream& lex, const AST::M
 extern void Parse_ModRoot_Items(TokenStream& lex, AST::Module& mod);
 
 
+/// Number of constructs parsed (on this thread) that need work in the expand pass
+/// - Macro invocations, attributes, interpolated fragments, `for`/`?` desugaring and block-local items.
+/// - `Parse_Expr` and `Parse_ExprBlock` compare this before and after parsing to flag the expression, so the
+///   expand pass only has to walk expressions that contain something to expand.
+extern thread_local unsigned int g_parse_expand_points;
+
 extern AST::Expr   Parse_Expr(TokenStream& lex);
 extern AST::Expr   Parse_ExprBlock(TokenStream& lex);
 extern AST::ExprNodeP   Parse_Expr0(TokenStream& lex);
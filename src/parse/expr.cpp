@@ -37,14 +37,22 @@ ExprNodeP Parse_Expr_Match(TokenStream& lex);
 ExprNodeP Parse_Expr1(TokenStream& lex);
 ExprNodeP Parse_ExprMacro(TokenStream& lex, Token tok);
 
+thread_local unsigned int g_parse_expand_points = 0;
+
 AST::Expr Parse_Expr(TokenStream& lex)
 {
-    return ::AST::Expr( Parse_Expr0(lex) );
+    auto expand_points = g_parse_expand_points;
+    auto rv = ::AST::Expr( Parse_Expr0(lex) );
+    rv.set_needs_expand( g_parse_expand_points != expand_points );
+    return rv;
 }
 
 AST::Expr Parse_ExprBlock(TokenStream& lex)
 {
-    return ::AST::Expr( Parse_ExprBlockNode(lex) );
+    auto expand_points = g_parse_expand_points;
+    auto rv = ::AST::Expr( Parse_ExprBlockNode(lex) );
+    rv.set_needs_expand( g_parse_expand_points != expand_points );
+    return rv;
 }
 
 ExprNodeP Parse_ExprBlockNode(TokenStream& lex, bool is_unsafe/*=false*/)
@@ -114,6 +122,7 @@ ExprNodeP Parse_ExprBlockLine_WithItems(TokenStream& lex, ::std::shared_ptr<AST:
     if( tok.type() == TOK_IDENT && tok.str() == "union" && lex.lookahead(0) == TOK_IDENT ) {
         PUTBACK(tok, lex);
         if( !local_mod ) {
+            g_parse_expand_points += 1;
             local_mod = lex.parse_state().get_current_mod().add_anon();
         }
         Parse_Mod_Item(lex, *local_mod, mv$(item_attrs));
@@ -137,6 +146,7 @@ ExprNodeP Parse_ExprBlockLine_WithItems(TokenStream& lex, ::std::shared_ptr<AST:
     case TOK_RWORD_MOD:
         PUTBACK(tok, lex);
         if( !local_mod ) {
+            g_parse_expand_points += 1;
             local_mod = lex.parse_state().get_current_mod().add_anon();
         }
         Parse_Mod_Item(lex, *local_mod, mv$(item_attrs));
@@ -147,6 +157,7 @@ ExprNodeP Parse_ExprBlockLine_WithItems(TokenStream& lex, ::std::shared_ptr<AST:
         {
             PUTBACK(tok, lex);
             if( !local_mod ) {
+                g_parse_expand_points += 1;
                 local_mod = lex.parse_state().get_current_mod().add_anon();
             }
             Parse_Mod_Item(lex, *local_mod, mv$(item_attrs));
@@ -338,6 +349,8 @@ ExprNodeP Parse_WhileStmt(TokenStream& lex, ::std::string lifetime)
 ExprNodeP Parse_ForStmt(TokenStream& lex, ::std::string lifetime)
 {
     Token   tok;
+    // `for` is desugared during expand
+    g_parse_expand_points += 1;
 
     // Irrefutable pattern
     AST::Pattern    pat = Parse_Pattern(lex, false);
@@ -889,6 +902,7 @@ ExprNodeP Parse_ExprFC(TokenStream& lex)
         switch(GET_TOK(tok, lex))
         {
         case TOK_QMARK:
+            g_parse_expand_points += 1;
             val = NEWNODE( AST::ExprNode_UniOp, AST::ExprNode_UniOp::QMARK, mv$(val) );
             break;
 
@@ -1251,6 +1265,7 @@ ExprNodeP Parse_ExprMacro(TokenStream& lex, Token tok)
     if( tt.is_token() ) {
         throw ParseError::Unexpected(lex, tt.tok());
     }
+    g_parse_expand_points += 1;
     return NEWNODE(AST::ExprNode_Macro, mv$(name), mv$(ident), mv$(tt));
 }
 
@@ -16,16 +16,26 @@
 #include <algorithm>    // std::count
 
 Lexer::Lexer(const ::std::string& filename):
-    m_path(filename.c_str()),
+    m_file( Span::intern_file(RcString::new_interned(filename)) ),
     m_line(1),
     m_line_ofs(0),
-    m_istream(filename.c_str()),
+    m_data_pos(0),
     m_last_char_valid(false),
     m_hygiene( Ident::Hygiene::new_scope() )
 {
-    if( !m_istream.is_open() )
     {
-        throw ::std::runtime_error("Unable to open file '" + filename + "'");
+        ::std::ifstream is(filename.c_str(), ::std::ios::in | ::std::ios::binary);
+        if( !is.is_open() )
+        {
+            throw ::std::runtime_error("Unable to open file '" + filename + "'");
+        }
+        is.seekg(0, ::std::ios::end);
+        m_data.resize( static_cast<size_t>(is.tellg()) );
+        is.seekg(0, ::std::ios::beg);
+        if( !m_data.empty() && !is.read(&m_data[0], m_data.size()) )
+        {
+            throw ::std::runtime_error("Unable to read file '" + filename + "'");
+        }
     }
     // Consume the BOM
     if( this->getc_byte() == '\xef' )
@@ -40,11 +50,33 @@ Lexer::Lexer(const ::std::string& filename):
     }
     else
     {
-        m_istream.unget();
+        m_data_pos = 0;
     }
 }
 
 
+namespace {
+    enum {
+        CC_SPACE = 1,   // Horizontal whitespace (not newline)
+        CC_IDENT = 2,   // ASCII identifier continuation
+    };
+    /// Byte classification table for the run scanners (non-ASCII bytes are never classified)
+    struct CharClasses {
+        uint8_t tab[256];
+        CharClasses() {
+            for(unsigned int i = 0; i < 256; i ++)
+            {
+                tab[i] = 0;
+                if( i == ' ' || i == '\t' || i == '\r' || i == 0xC )
+                    tab[i] |= CC_SPACE;
+                if( i < 128 && (::std::isalnum(i) || i == '_') )
+                    tab[i] |= CC_IDENT;
+            }
+        }
+    };
+    const CharClasses   s_char_classes;
+}
+
 #define LINECOMMENT -1
 #define BLOCKCOMMENT -2
 #define SINGLEQUOTE -3
@@ -233,7 +265,7 @@ bool issym(Codepoint ch)
 
 Position Lexer::getPosition() const
 {
-    return Position(m_path, m_line, m_line_ofs);
+    return Position(m_file, m_line, m_line_ofs);
 }
 Ident::Hygiene Lexer::realGetHygiene() const
 {
@@ -298,6 +330,7 @@ Token Lexer::getTokenInt()
             return Token(TOK_NEWLINE);
         if( ch.isspace() )
         {
+            this->skip_ascii_run(CC_SPACE);
             while( (ch = this->getc()).isspace() && ch != '\n' )
                 ;
             this->ungetc();
@@ -558,14 +591,23 @@ Token Lexer::getTokenInt()
             case LINECOMMENT: {
                 // Line comment
                 ::std::string   str;
-                auto ch = this->getc();
-                while(ch != '\n' && ch != '\r')
+                if( m_last_char_valid )
                 {
-                    str += ch;
-                    ch = this->getc();
+                    if( m_last_char == '\n' || m_last_char == '\r' )
+                        return Token(TOK_COMMENT, str);
+                    str += m_last_char;
+                    m_last_char_valid = false;
                 }
-                this->ungetc();
-                return Token(TOK_COMMENT, str); }
+                // - Scan straight to the end of the line in the buffer, counting codepoints for the column
+                size_t start = m_data_pos;
+                while( m_data_pos < m_data.size() && m_data[m_data_pos] != '\n' && m_data[m_data_pos] != '\r' )
+                {
+                    if( (m_data[m_data_pos] & 0xC0) != 0x80 )
+                        m_line_ofs ++;
+                    m_data_pos ++;
+                }
+                str.append(m_data, start, m_data_pos - start);
+                return Token(TOK_COMMENT, mv$(str)); }
             case BLOCKCOMMENT: {
                 ::std::string   str;
                 unsigned int level = 0;
@@ -741,6 +783,10 @@ Token Lexer::getTokenInt_Identifier(Codepoint leader, Codepoint leader2)
     while( issym(ch) )
     {
         str += ch;
+        // Take any following run of plain ASCII identifier characters in one go
+        size_t start = m_data_pos;
+        size_t len = this->skip_ascii_run(CC_IDENT);
+        str.append(m_data, start, len);
         ch = this->getc();
     }
 
@@ -873,9 +919,9 @@ uint32_t Lexer::parseEscape(char enclosing)
 
 char Lexer::getc_byte()
 {
-    char rv = m_istream.get();
-    if( m_istream.eof() )
+    if( m_data_pos == m_data.size() )
         throw Lexer::EndOfFile();
+    char rv = m_data[m_data_pos++];
 
     if( rv == '\n' )
     {
@@ -900,6 +946,20 @@ Codepoint Lexer::getc()
     return m_last_char;
 }
 
+/// Consume a run of bytes matching `classes` directly from the buffer, returning the number consumed
+///
+/// Only applies when there's no pushed-back character, and the classes never include newlines or non-ASCII bytes,
+/// so the column can be updated without decoding.
+size_t Lexer::skip_ascii_run(uint8_t classes)
+{
+    if( m_last_char_valid )
+        return 0;
+    size_t start = m_data_pos;
+    while( m_data_pos < m_data.size() && (s_char_classes.tab[static_cast<uint8_t>(m_data[m_data_pos])] & classes) )
+        m_data_pos ++;
+    m_line_ofs += m_data_pos - start;
+    return m_data_pos - start;
+}
 Codepoint Lexer::getc_num()
 {
     Codepoint ch;
@@ -32,11 +32,13 @@ typedef Codepoint   uchar;
 class Lexer:
     public TokenStream
 {
-    RcString    m_path;
+    uint32_t    m_file;
     unsigned int m_line;
     unsigned int m_line_ofs;
 
-    ::std::ifstream m_istream;
+    /// Entire source file, read in one go and scanned with a cursor
+    ::std::string   m_data;
+    size_t  m_data_pos;
     bool    m_last_char_valid;
     Codepoint   m_last_char;
     Token   m_next_token;   // Used when lexing generated two tokens
@@ -63,6 +65,7 @@ private:
     Codepoint getc();
     Codepoint getc_cp();
     char getc_byte();
+    size_t skip_ascii_run(uint8_t classes);
 
     class EndOfFile {};
 };
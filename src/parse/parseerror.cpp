@@ -8,6 +8,22 @@
 #include "parseerror.hpp"
 #include <iostream>
 
+namespace {
+    thread_local ::std::ostream*    t_output = nullptr;
+}
+::std::ostream& CompileError::output()
+{
+    return t_output ? *t_output : ::std::cout;
+}
+void CompileError::set_output(::std::ostream* os)
+{
+    t_output = os;
+}
+bool CompileError::output_redirected()
+{
+    return t_output != nullptr;
+}
+
 CompileError::Base::~Base() throw()
 {
 }
@@ -15,41 +31,49 @@ CompileError::Base::~Base() throw()
 CompileError::Generic::Generic(::std::string message):
     m_message(message)
 {
-    ::std::cout << "Generic(" << message << ")" << ::std::endl;
+    CompileError::output() << "Generic(" << message << ")" << ::std::endl;
 }
 CompileError::Generic::Generic(const TokenStream& lex, ::std::string message)
 {
-    ::std::cout << lex.getPosition() << ": Generic(" << message << ")" << ::std::endl;
+    CompileError::output() << lex.getPosition() << ": Generic(" << message << ")" << ::std::endl;
 }
 
 CompileError::BugCheck::BugCheck(const TokenStream& lex, ::std::string message):
     m_message(message)
 {
-    ::std::cout << lex.getPosition() << "BugCheck(" << message << ")" << ::std::endl;
+    CompileError::output() << lex.getPosition() << "BugCheck(" << message << ")" << ::std::endl;
 }
 CompileError::BugCheck::BugCheck(::std::string message):
     m_message(message)
 {
-    ::std::cout << "BugCheck(" << message << ")" << ::std::endl;
+    CompileError::output() << "BugCheck(" << message << ")" << ::std::endl;
 }
 
 CompileError::Todo::Todo(::std::string message):
     m_message(message)
 {
-    ::std::cout << "Todo(" << message << ")" << ::std::endl;
+    CompileError::output() << "Todo(" << message << ")" << ::std::endl;
 }
 CompileError::Todo::Todo(const TokenStream& lex, ::std::string message):
     m_message(message)
 {
-    ::std::cout << lex.getPosition() << ": Todo(" << message << ")" << ::std::endl;
+    CompileError::output() << lex.getPosition() << ": Todo(" << message << ")" << ::std::endl;
 }
 CompileError::Todo::~Todo() throw()
 {
 }
 
+CompileError::Fatal::Fatal(::std::string message):
+    m_message( ::std::move(message) )
+{
+}
+CompileError::Fatal::~Fatal() throw()
+{
+}
+
 ParseError::BadChar::BadChar(const TokenStream& lex, char character)
 {
-    ::std::cout << lex.getPosition() << ": BadChar(" << character << ")" << ::std::endl;
+    CompileError::output() << lex.getPosition() << ": BadChar(" << character << ")" << ::std::endl;
 }
 ParseError::BadChar::~BadChar() throw()
 {
@@ -59,32 +83,33 @@ ParseError::Unexpected::Unexpected(const TokenStream& lex, const Token& tok)//:
 //    m_tok( mv$(tok) )
 {
     auto pos = tok.get_pos();
-    if(pos.filename == "")
+    if(pos.file == 0)
         pos = lex.getPosition();
-    ::std::cout << pos << ": Unexpected(" << tok << ")" << ::std::endl;
+    CompileError::output() << pos << ": Unexpected(" << tok << ")" << ::std::endl;
 }
 ParseError::Unexpected::Unexpected(const TokenStream& lex, const Token& tok, Token exp)//:
 //    m_tok( mv$(tok) )
 {
     auto pos = tok.get_pos();
-    if(pos.filename == "")
+    if(pos.file == 0)
         pos = lex.getPosition();
-    ::std::cout << pos << ": Unexpected(" << tok << ", " << exp << ")" << ::std::endl;
+    CompileError::output() << pos << ": Unexpected(" << tok << ", " << exp << ")" << ::std::endl;
 }
 ParseError::Unexpected::Unexpected(const TokenStream& lex, const Token& tok, ::std::vector<eTokenType> exp)
 {
     auto pos = tok.get_pos();
-    if(pos.filename == "")
+    if(pos.file == 0)
         pos = lex.getPosition();
-    ::std::cout << pos << ": Unexpected " << tok << ", expected ";
+    auto& os = CompileError::output();
+    os << pos << ": Unexpected " << tok << ", expected ";
     bool f = true;
     for(auto v: exp) {
         if(!f)
-            ::std::cout << " or ";
+            os << " or ";
         f = false;
-        ::std::cout << Token::typestr(v);
+        os << Token::typestr(v);
     }
-    ::std::cout << ::std::endl;
+    os << ::std::endl;
 }
 ParseError::Unexpected::~Unexpected() throw()
 {
@@ -355,7 +355,6 @@ AST::Pattern Parse_PatternReal_Slice(TokenStream& lex, bool is_refutable)
 ::AST::Pattern::TuplePat Parse_PatternTuple(TokenStream& lex, bool is_refutable)
 {
     TRACE_FUNCTION;
-    auto sp = lex.start_span();
     Token tok;
 
     ::std::vector<AST::Pattern> leading;
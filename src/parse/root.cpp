@@ -18,6 +18,9 @@
 #include <expand/cfg.hpp>   // check_cfg - for `mod nonexistant;`
 #include <fstream>  // Used by directory path
 #include "lex.hpp"  // New file lexer
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 template<typename T>
 Spanned<T> get_spanned(TokenStream& lex, ::std::function<T()> f) {
@@ -43,6 +46,12 @@ Spanned<T> get_spanned(TokenStream& lex, ::std::function<T()> f) {
 AST::MetaItem   Parse_MetaItem(TokenStream& lex);
 void Parse_ModRoot(TokenStream& lex, AST::Module& mod, AST::MetaItems& mod_attrs);
 
+namespace {
+    /// When set, `mod foo;` records the located file in the module instead of parsing it (the files are then
+    /// parsed by worker threads, see Parse_Crate)
+    bool g_defer_mod_files = false;
+}
+
 //::AST::Path Parse_Publicity(TokenStream& lex)
 bool Parse_Publicity(TokenStream& lex, bool allow_restricted=true)
 {
@@ -809,8 +818,6 @@ AST::Enum Parse_EnumDef(TokenStream& lex, const AST::MetaItems& meta_items)
     ::std::vector<AST::EnumVariant>   variants;
     while( GET_TOK(tok, lex) != TOK_BRACE_CLOSE )
     {
-        auto sp = lex.start_span();
-
         AST::MetaItems  item_attrs;
         while( tok.type() == TOK_ATTR_OPEN )
         {
@@ -956,6 +963,7 @@ AST::MetaItem Parse_MetaItem(TokenStream& lex)
     TRACE_FUNCTION;
     Token tok;
     GET_TOK(tok, lex);
+    g_parse_expand_points += 1;
 
     if( tok.type() == TOK_INTERPOLATED_META ) {
         return mv$(tok.frag_meta());
@@ -1406,6 +1414,7 @@ void Parse_Use(TokenStream& lex, ::std::function<void(AST::UseStmt, ::std::strin
     }
     DEBUG("name=" << name << ", ident=" << ident);
     TokenTree tt = Parse_TT(lex, true);
+    g_parse_expand_points += 1;
     return ::AST::MacroInvocation( lex.end_span(span_start), mv$(name), mv$(ident), mv$(tt));
 }
 
@@ -1792,9 +1801,16 @@ void Parse_Use(TokenStream& lex, ::std::function<void(AST::UseStmt, ::std::strin
                     ERROR(lex.getPosition(), E0000, "Can't find file for '" << name << "' in '" << mod_fileinfo.path << "'");
                 }
                 DEBUG("- path = " << submod.m_file_info.path);
-                Lexer sub_lex(submod.m_file_info.path);
-                Parse_ModRoot(sub_lex, submod, meta_items);
-                GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+                if( g_defer_mod_files )
+                {
+                    submod.m_file_info.load_pending = true;
+                }
+                else
+                {
+                    Lexer sub_lex(submod.m_file_info.path);
+                    Parse_ModRoot(sub_lex, submod, meta_items);
+                    GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+                }
             }
             break;
         default:
@@ -1892,10 +1908,152 @@ void Parse_ModRoot(TokenStream& lex, AST::Module& mod, AST::MetaItems& mod_attrs
     Parse_ModRoot_Items(lex, mod);
 }
 
-AST::Crate Parse_Crate(::std::string mainfile)
+namespace {
+    /// A module whose file still needs to be parsed, and the attribute list its inner attributes are added to
+    struct PendingModFile {
+        AST::Module*    mod;
+        AST::MetaItems* attrs;
+        /// Source order: index of the `mod` item within each file from the crate root down to this one
+        ::std::vector<unsigned int> order;
+    };
+    /// Collect modules left pending by parsing a file (the file's item lists are complete, so the pointers are stable)
+    /// - Items are visited in source order (then anonymous modules), so the index in `out` gives the order in the file
+    void Parse_GetPendingMods(AST::Module& mod, const ::std::vector<unsigned int>& parent_order, ::std::vector<PendingModFile>& out)
+    {
+        for(auto& i : mod.items())
+        {
+            if( !i.data.is_Module() )
+                continue ;
+            auto& submod = i.data.as_Module();
+            if( submod.m_file_info.load_pending )
+            {
+                auto order = parent_order;
+                order.push_back( static_cast<unsigned int>(out.size()) );
+                out.push_back( PendingModFile { &submod, &i.data.attrs, mv$(order) } );
+            }
+            else
+            {
+                Parse_GetPendingMods(submod, parent_order, out);
+            }
+        }
+        for(auto& m : mod.anon_mods())
+        {
+            if( m )
+                Parse_GetPendingMods(*m, parent_order, out);
+        }
+    }
+    void Parse_PendingModFile(const PendingModFile& ent)
+    {
+        TRACE_FUNCTION_F(ent.mod->m_file_info.path);
+        Token   tok;
+        ent.mod->m_file_info.load_pending = false;
+        Lexer sub_lex(ent.mod->m_file_info.path);
+        Parse_ModRoot(sub_lex, *ent.mod, *ent.attrs);
+        GET_CHECK_TOK(tok, sub_lex, TOK_EOF);
+    }
+    /// Parse all pending module files under `root` on a pool of worker threads
+    ///
+    /// Each file is parsed independently into its (already placed) module, and any `mod foo;` items it contains are
+    /// queued in turn. If parsing fails, the error that comes first in source order (i.e. the one a single-threaded
+    /// parse would have hit) is printed and re-thrown once the pool has stopped. Files after that point are skipped.
+    /// - Output is redirected on the workers, so fatal errors (`ERROR`/`BUG`) are thrown too, see `CompileError::Fatal`
+    void Parse_PendingModFiles(AST::Module& root, unsigned int num_threads)
+    {
+        ::std::mutex    lock;
+        ::std::condition_variable   cv;
+        ::std::vector<PendingModFile>   queue;
+        unsigned int    n_active = 0;
+        ::std::exception_ptr    error;
+        ::std::vector<unsigned int> error_order;
+        ::std::string   error_output;
+
+        Parse_GetPendingMods(root, {}, queue);
+        DEBUG(queue.size() << " module files, " << num_threads << " threads");
+
+        const auto phase = debug_get_phase();
+        auto worker = [&]() {
+            debug_set_phase(phase);
+            ::std::unique_lock< ::std::mutex>   lh(lock);
+            for(;;)
+            {
+                cv.wait(lh, [&](){ return !queue.empty() || n_active == 0; });
+                // Stop once the queue is empty and nothing else is running (so no more can be added)
+                if( queue.empty() )
+                    break;
+                auto ent = mv$(queue.back());
+                queue.pop_back();
+                // Anything after an existing error in source order can't change the reported error
+                if( error && error_order < ent.order )
+                    continue ;
+                n_active ++;
+                lh.unlock();
+
+                ::std::vector<PendingModFile>   new_ents;
+                ::std::exception_ptr    new_error;
+                // Error messages are held back until it's known which error gets reported
+                ::std::stringstream output;
+                CompileError::set_output(&output);
+                try
+                {
+                    Parse_PendingModFile(ent);
+                    Parse_GetPendingMods(*ent.mod, ent.order, new_ents);
+                }
+                catch(...)
+                {
+                    new_error = ::std::current_exception();
+                }
+                CompileError::set_output(nullptr);
+
+                lh.lock();
+                n_active --;
+                if( !new_error )
+                {
+                    ::std::cout << output.str();
+                }
+                else if( !error || ent.order < error_order )
+                {
+                    error = new_error;
+                    error_order = mv$(ent.order);
+                    error_output = output.str();
+                }
+                for(auto& e : new_ents)
+                    queue.push_back( mv$(e) );
+                cv.notify_all();
+            }
+        };
+
+        ::std::vector< ::std::thread>   threads;
+        for(unsigned int i = 1; i < num_threads; i ++)
+            threads.push_back( ::std::thread(worker) );
+        worker();
+        for(auto& t : threads)
+            t.join();
+
+        if( error )
+        {
+            ::std::cout << error_output << ::std::flush;
+            try
+            {
+                ::std::rethrow_exception(error);
+            }
+            catch(const CompileError::Fatal& e)
+            {
+                // An `ERROR`/`BUG` on a worker, report it the same way as a single-threaded parse would
+                ::std::cerr << e.message() << ::std::endl;
+                abort();
+            }
+        }
+    }
+}
+
+AST::Crate Parse_Crate(::std::string mainfile, unsigned int num_threads)
 {
     Token   tok;
 
+    // With multiple threads, the root file is parsed on this thread and the module files it references are
+    // handed off to workers.
+    g_defer_mod_files = (num_threads > 1);
+
     Lexer lex(mainfile);
 
     size_t p = mainfile.find_last_of('/');
@@ -1908,5 +2066,12 @@ AST::Crate Parse_Crate(::std::string mainfile)
 
     Parse_ModRoot(lex, crate.root_module(), crate.m_attrs);
 
+    if( g_defer_mod_files )
+    {
+        Parse_PendingModFiles(crate.root_module(), num_threads);
+        // Module files loaded after this point (e.g. from macro-expanded items) are parsed inline
+        g_defer_mod_files = false;
+    }
+
     return crate;
 }
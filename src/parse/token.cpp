@@ -49,9 +49,24 @@ Token::Token(enum eTokenType type):
     m_type(type)
 {
 }
+namespace {
+    RcString token_string(enum eTokenType type, const ::std::string& str)
+    {
+        switch(type)
+        {
+        // Names are repeated throughout a crate (and duplicated by macro expansion), so share one copy
+        case TOK_IDENT:
+        case TOK_MACRO:
+        case TOK_LIFETIME:
+            return RcString::new_interned(str);
+        default:
+            return RcString(str);
+        }
+    }
+}
 Token::Token(enum eTokenType type, ::std::string str):
     m_type(type),
-    m_data(Data::make_String(mv$(str)))
+    m_data(Data::make_String( token_string(type, str) ))
 {
 }
 Token::Token(uint64_t val, enum eCoreType datatype):
@@ -144,8 +159,8 @@ Token::Token(TagTakeIP, InterpolatedFragment frag)
 
 Token::Token(const Token& t):
     m_type(t.m_type),
-    m_data( Data::make_None({}) ),
-    m_pos( t.m_pos )
+    m_pos( t.m_pos ),
+    m_data( Data::make_None({}) )
 {
     assert( t.m_data.tag() != Data::TAGDEAD );
     TU_MATCH(Data, (t.m_data), (e),
@@ -289,7 +304,7 @@ struct EscapedString {
 
     case TOK_NEWLINE:    return "\n";
     case TOK_WHITESPACE: return " ";
-    case TOK_COMMENT:    return "/*" + m_data.as_String() + "*/";
+    case TOK_COMMENT:    return "/*" + str() + "*/";
     case TOK_INTERPOLATED_TYPE: return FMT( *reinterpret_cast<const ::TypeRef*>(m_data.as_Fragment()) );
     case TOK_INTERPOLATED_PATH: return FMT( *reinterpret_cast<const ::AST::Path*>(m_data.as_Fragment()) );
     case TOK_INTERPOLATED_PATTERN: return FMT( *reinterpret_cast<const ::AST::Pattern*>(m_data.as_Fragment()) );
@@ -304,14 +319,14 @@ struct EscapedString {
     case TOK_INTERPOLATED_ITEM: return "/*:item*/";
     case TOK_INTERPOLATED_IDENT: return "/*:ident*/";
     // Value tokens
-    case TOK_IDENT:     return m_data.as_String();
-    case TOK_MACRO:     return m_data.as_String() + "!";
-    case TOK_LIFETIME:  return "'" + m_data.as_String();
+    case TOK_IDENT:     return str();
+    case TOK_MACRO:     return str() + "!";
+    case TOK_LIFETIME:  return "'" + str();
     case TOK_INTEGER:   return FMT(m_data.as_Integer().m_intval);    // TODO: suffix for type
     case TOK_CHAR:      return FMT("'\\u{"<< ::std::hex << m_data.as_Integer().m_intval << "}");
     case TOK_FLOAT:     return FMT(m_data.as_Float().m_floatval);
-    case TOK_STRING:    return FMT("\"" << EscapedString(m_data.as_String()) << "\"");
-    case TOK_BYTESTRING:return FMT("b\"" << m_data.as_String() << "\"");
+    case TOK_STRING:    return FMT("\"" << EscapedString(str()) << "\"");
+    case TOK_BYTESTRING:return FMT("b\"" << str() << "\"");
     case TOK_CATTR_OPEN:return "#![";
     case TOK_ATTR_OPEN: return "#[";
     case TOK_UNDERSCORE:return "_";
@@ -463,7 +478,7 @@ SERIALISE_TYPE(Token::, "Token", {
     TU_MATCH(Token::Data, (m_data), (e),
     (None, ),
     (String,
-        s << e;
+        s << ::std::string(e.c_str(), e.size());
         ),
     (Integer,
         s % e.m_datatype;
@@ -492,7 +507,7 @@ SERIALISE_TYPE(Token::, "Token", {
     case Token::Data::TAG_String: {
         ::std::string str;
         s.item( str );
-        m_data = Token::Data::make_String(str);
+        m_data = Token::Data::make_String( token_string(m_type, str) );
         break; }
     case Token::Data::TAG_Integer: {
         enum eCoreType  dt;
@@ -560,8 +575,18 @@ SERIALISE_TYPE(Token::, "Token", {
     }
     return os;
 }
+Position::Position(const RcString& filename, unsigned int line, unsigned int ofs):
+    file( Span::intern_file(filename) ),
+    line(line),
+    ofs(ofs)
+{
+}
+const RcString& Position::filename() const
+{
+    return Span::file_name(this->file);
+}
 ::std::ostream& operator<<(::std::ostream& os, const Position& p)
 {
-    return os << ::std::dec << p.filename << ":" << p.line;
+    return os << ::std::dec << p.filename() << ":" << p.line;
 }
 
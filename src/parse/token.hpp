@@ -20,24 +20,31 @@ enum eTokenType
     #undef _
 };
 
+/// Location of a token
+///
+/// The file is stored as an index into the source map's file table (see `Span::intern_file`), so positions are
+/// trivially copyable and tokens don't carry a refcounted string each. File index 0 is the empty/unknown file.
 class Position
 {
 public:
-    RcString    filename;
+    uint32_t    file;
     unsigned int    line;
     unsigned int    ofs;
 
     Position():
-        filename(""),
+        file(0),
         line(0),
         ofs(0)
     {}
-    Position(RcString filename, unsigned int line, unsigned int ofs):
-        filename(filename),
+    Position(uint32_t file, unsigned int line, unsigned int ofs):
+        file(file),
         line(line),
         ofs(ofs)
     {
     }
+    Position(const RcString& filename, unsigned int line, unsigned int ofs);
+
+    const RcString& filename() const;
 };
 extern ::std::ostream& operator<<(::std::ostream& os, const Position& p);
 
@@ -60,7 +67,8 @@ class Token:
 {
     TAGGED_UNION(Data, None,
     (None, struct {}),
-    (String, ::std::string),
+    // NOTE: Identifiers/lifetimes are interned (see `Token::Token(eTokenType, ::std::string)`), so copies share storage
+    (String, RcString),
     (Integer, struct {
         enum eCoreType  m_datatype;
         uint64_t    m_intval;
@@ -72,9 +80,10 @@ class Token:
     (Fragment, void*)
     );
 
+    // NOTE: Position is kept next to the type so it packs into the padding before the payload
     enum eTokenType m_type;
-    Data    m_data;
     Position    m_pos;
+    Data    m_data;
 
 public:
     virtual ~Token();
@@ -83,13 +92,13 @@ public:
     {
         m_type = t.m_type;  t.m_type = TOK_NULL;
         m_data = ::std::move(t.m_data);
-        m_pos = ::std::move(t.m_pos);
+        m_pos = t.m_pos;
         return *this;
     }
     Token(Token&& t):
         m_type(t.m_type),
-        m_data( ::std::move(t.m_data) ),
-        m_pos( ::std::move(t.m_pos) )
+        m_pos( t.m_pos ),
+        m_data( ::std::move(t.m_data) )
     {
         t.m_type = TOK_NULL;
     }
@@ -105,8 +114,9 @@ public:
     Token(TagTakeIP, InterpolatedFragment );
 
     enum eTokenType type() const { return m_type; }
-    ::std::string& str() { return m_data.as_String(); }
-    const ::std::string& str() const { return m_data.as_String(); }
+    ::std::string str() const { const auto& s = m_data.as_String(); return ::std::string(s.c_str(), s.size()); }
+    /// String payload without a copy (cheap to hash/compare, interned for identifiers)
+    const RcString& istr() const { return m_data.as_String(); }
     enum eCoreType  datatype() const { TU_MATCH_DEF(Data, (m_data), (e), (assert(!"Getting datatype of invalid token type");), (Integer, return e.m_datatype;), (Float, return e.m_datatype;)) }
     uint64_t intval() const { return m_data.as_Integer().m_intval; }
     double floatval() const { return m_data.as_Float().m_floatval; }
@@ -8,6 +8,7 @@
 #include "tokenstream.hpp"
 #include <common.hpp>
 #include "parseerror.hpp"
+#include "common.hpp"  // g_parse_expand_points
 
 const bool DEBUG_PRINT_TOKENS = false;
 //const bool DEBUG_PRINT_TOKENS = true;
@@ -24,8 +25,11 @@ TokenStream::~TokenStream()
 Token TokenStream::innerGetToken()
 {
     Token ret = this->realGetToken();
-    if( ret.get_pos().filename == "" )
+    if( ret.get_pos().file == 0 )
         ret.set_pos( this->getPosition() );
+    // Fragments from a macro can contain anything, so the expression they end up in needs to be expanded
+    if( TOK_INTERPOLATED_PATH <= ret.type() && ret.type() <= TOK_INTERPOLATED_ITEM )
+        g_parse_expand_points += 1;
     //DEBUG("ret.get_pos() = " << ret.get_pos());
     return ret;
 }
@@ -105,7 +109,7 @@ ProtoSpan TokenStream::start_span() const
 {
     auto p = this->getPosition();
     return ProtoSpan {
-        .filename = p.filename,
+        .file = p.file,
         .start_line = p.line,
         .start_ofs = p.ofs,
         };
@@ -114,7 +118,7 @@ Span TokenStream::end_span(ProtoSpan ps) const
 {
     auto p = this->getPosition();
     return Span(
-        ps.filename,
+        ps.file,
         ps.start_line, ps.start_ofs,
         p.line, p.ofs
         );
@@ -12,13 +12,17 @@
 #include <ident.hpp>
 #include <vector>
 
+/// A single token, or a group of sub-trees
+///
+/// NOTE: Groups hold their sub-trees directly (not as ranges of one flat buffer per tree) - callers hold references to
+/// sub-trees (`operator[]`), build trees bottom-up from `::std::vector<TokenTree>`, and `TTStreamO` moves tokens out
+/// of the tree in place.
 class TokenTree
 {
     Ident::Hygiene m_hygiene;
     Token   m_tok;
     ::std::vector<TokenTree>    m_subtrees;
 public:
-    virtual ~TokenTree() {}
     TokenTree() {}
     TokenTree(TokenTree&&) = default;
     TokenTree& operator=(TokenTree&&) = default;
@@ -27,8 +27,9 @@ Token TTStream::realGetToken()
 
         if(idx == 0 && tree.is_token()) {
             idx ++;
+            m_last_pos = tree.tok().get_pos();
             m_hygiene_ptr = &tree.hygiene();
-            return tree.tok();
+            return tree.tok().clone();
         }
 
         if(idx < tree.size())
@@ -36,6 +37,7 @@ Token TTStream::realGetToken()
             const TokenTree&    subtree = tree[idx];
             idx ++;
             if( subtree.size() == 0 ) {
+                m_last_pos = subtree.tok().get_pos();
                 m_hygiene_ptr = &subtree.hygiene();
                 return subtree.tok().clone();
             }
@@ -52,7 +54,7 @@ Token TTStream::realGetToken()
 }
 Position TTStream::getPosition() const
 {
-    return Position("TTStream", 0,0);
+    return m_last_pos;
 }
 Ident::Hygiene TTStream::realGetHygiene() const
 {
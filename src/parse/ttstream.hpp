@@ -11,9 +11,11 @@
 #include "tokenstream.hpp"
 
 /// Borrowed TTStream
+/// - Returned tokens are clones, but string payloads are refcounted (see `Token`) so the tree's tokens are shared
 class TTStream:
     public TokenStream
 {
+    Position    m_last_pos;
     ::std::vector< ::std::pair<unsigned int, const TokenTree*> > m_stack;
     const Ident::Hygiene*   m_hygiene_ptr = nullptr;
 public:
@@ -1,44 +1,135 @@
 /*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * rc_string.cpp
+ * - Reference-counted immutable string
  */
 #include <rc_string.hpp>
 #include <cstring>
+#include <cstddef>    // offsetof
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
+struct RcString::Inner
+{
+    ::std::atomic<unsigned int> refcount;
+    size_t  hash;
+    char    data[1];
+
+    static size_t calc_hash(const char* s, unsigned int len)
+    {
+        // FNV-1a
+        size_t  h = 14695981039346656037ull;
+        for(unsigned int i = 0; i < len; i ++)
+        {
+            h ^= static_cast<uint8_t>(s[i]);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+    static Inner* alloc(const char* s, unsigned int len)
+    {
+        void* mem = ::operator new(offsetof(Inner, data) + len + 1);
+        Inner* rv = new(mem) Inner;
+        rv->refcount.store(1, ::std::memory_order_relaxed);
+        rv->hash = calc_hash(s, len);
+        ::std::memcpy(rv->data, s, len);
+        rv->data[len] = '\0';
+        return rv;
+    }
+};
+
+namespace {
+    /// Global intern pool, holds one reference to each interned string
+    struct InternPool
+    {
+        struct Hash {
+            size_t operator()(const RcString& s) const { return s.hash(); }
+        };
+        ::std::mutex    lock;
+        ::std::unordered_set<RcString, Hash>    strings;
+    };
+    InternPool& intern_pool()
+    {
+        static InternPool   s_pool;
+        return s_pool;
+    }
+}
 
 RcString::RcString(const char* s, unsigned int len):
-    m_ptr(nullptr),
     m_len(len)
 {
-    if( len > 0 )
+    if( is_inline() )
     {
-        m_ptr = new unsigned int[1 + (len+1 + sizeof(unsigned int)-1) / sizeof(unsigned int)];
-        *m_ptr = 1;
-        char* data_mut = reinterpret_cast<char*>(m_ptr + 1);
-        for(unsigned int j = 0; j < len; j ++ )
-            data_mut[j] = s[j];
-        data_mut[len] = '\0';
+        ::std::memcpy(m_inline, s, len);
+        m_inline[len] = '\0';
+    }
+    else
+    {
+        m_ptr = Inner::alloc(s, len);
     }
 }
-RcString::~RcString()
+RcString RcString::new_interned(const char* s, unsigned int len)
 {
-    if(m_ptr)
+    RcString    rv(s, len);
+    // Short strings are inline and cheap to compare, no point interning them
+    if( rv.is_inline() )
+        return rv;
+
+    auto& pool = intern_pool();
+    ::std::lock_guard< ::std::mutex>    lh(pool.lock);
+    return *pool.strings.insert( ::std::move(rv) ).first;
+}
+
+void RcString::inc_ref()
+{
+    m_ptr->refcount.fetch_add(1, ::std::memory_order_relaxed);
+}
+void RcString::dec_ref()
+{
+    if( m_ptr->refcount.fetch_sub(1, ::std::memory_order_acq_rel) == 1 )
     {
-        *m_ptr -= 1;
-        //::std::cout << "RcString(\"" << *this << "\") - " << *m_ptr << " refs left" << ::std::endl;
-        if( *m_ptr == 0 )
-        {
-            delete[] m_ptr;
-            m_ptr = nullptr;
-        }
+        m_ptr->~Inner();
+        ::operator delete(m_ptr);
+    }
+    m_ptr = nullptr;
+}
+
+const char* RcString::c_str() const
+{
+    if( is_inline() )
+    {
+        return m_inline;
+    }
+    else
+    {
+        return m_ptr->data;
+    }
+}
+size_t RcString::hash() const
+{
+    if( is_inline() )
+    {
+        return Inner::calc_hash(m_inline, m_len);
+    }
+    else
+    {
+        return m_ptr->hash;
     }
 }
-bool RcString::operator==(const char* s) const
+bool RcString::operator==(const RcString& x) const
 {
-    if( m_len == 0 )
-        return *s == '\0';
-    auto m = this->c_str();
-    do {
-        if( *m != *s )
-            return false;
-    } while( *m++ != '\0' && *s++ != '\0' );
-    return true;
+    if( m_len != x.m_len )
+        return false;
+    if( is_inline() )
+        return ::std::memcmp(m_inline, x.m_inline, m_len) == 0;
+    // Heap strings: shared (or interned) storage is equal, differing hashes are not
+    if( m_ptr == x.m_ptr )
+        return true;
+    if( m_ptr->hash != x.m_ptr->hash )
+        return false;
+    return ::std::memcmp(m_ptr->data, x.m_ptr->data, m_len) == 0;
 }
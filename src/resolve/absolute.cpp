@@ -1024,7 +1024,69 @@ namespace {
     }
 }
 
+namespace {
+    /// Index of already-bound absolute paths, so common prefixes (e.g. `::std::io`) aren't re-walked for every use.
+    /// - Keyed on the lookup mode and the path, only paths without generic parameters are stored.
+    /// - Only active during `Resolve_Absolutise`, as the bindings point into the crate's items.
+    struct BindAbsoluteCache
+    {
+        struct Ent {
+            Context::LookupMode mode;
+            ::AST::Path path;
+        };
+
+        bool    enabled = false;
+        ::std::unordered_map< ::std::string, Ent>   map;
+        unsigned int    hits = 0;
+        unsigned int    misses = 0;
+
+        static bool make_key(const ::AST::Path& path, Context::LookupMode mode, ::std::string& out)
+        {
+            const auto& path_abs = path.m_class.as_Absolute();
+            out.clear();
+            out += static_cast<char>('0' + static_cast<int>(mode));
+            out += path_abs.crate;
+            for(const auto& n : path_abs.nodes)
+            {
+                if( !n.args().is_empty() )
+                    return false;
+                out += "::";
+                out += n.name();
+            }
+            return true;
+        }
+    } g_bind_absolute_cache;
+}
+
+void Resolve_Absolute_Path_BindAbsolute_Inner(Context& context, const Span& sp, Context::LookupMode& mode, ::AST::Path& path);
 void Resolve_Absolute_Path_BindAbsolute(Context& context, const Span& sp, Context::LookupMode& mode, ::AST::Path& path)
+{
+    auto& cache = g_bind_absolute_cache;
+    ::std::string   key;
+    if( !cache.enabled || !BindAbsoluteCache::make_key(path, mode, key) ) {
+        return Resolve_Absolute_Path_BindAbsolute_Inner(context, sp, mode, path);
+    }
+
+    auto it = cache.map.find(key);
+    if( it != cache.map.end() )
+    {
+        cache.hits ++;
+        DEBUG("Cached " << path << " = " << it->second.path);
+        mode = it->second.mode;
+        path = ::AST::Path(it->second.path);
+        return ;
+    }
+    cache.misses ++;
+
+    Resolve_Absolute_Path_BindAbsolute_Inner(context, sp, mode, path);
+
+    // UFCS results (from types/traits in the path) are resolved further against the current context, so aren't stored
+    if( path.m_class.is_Absolute() )
+    {
+        cache.map.insert( ::std::make_pair(mv$(key), BindAbsoluteCache::Ent { mode, path }) );
+    }
+}
+void Resolve_Absolute_Path_BindAbsolute_Inner(Context& context, const Span& sp, Context::LookupMode& mode, ::AST::Path& path)
 {
     TRACE_FUNCTION_FR("path = " << path, path);
     auto& path_abs = path.m_class.as_Absolute();
@@ -2169,7 +2231,14 @@ void Resolve_Absolute_Mod( Context item_context, ::AST::Module& mod )
 
 void Resolve_Absolutise(AST::Crate& crate)
 {
+    auto& cache = g_bind_absolute_cache;
+    cache.enabled = true;
+
     Resolve_Absolute_Mod(crate, crate.root_module());
+
+    DEBUG("Bound path cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.map.size() << " entries");
+    cache.map.clear();
+    cache.enabled = false;
 }
 
 
@@ -485,42 +485,100 @@ void Resolve_Index_Module_Wildcard__use_stmt(AST::Crate& crate, AST::Module& dst
     }
 }
 
+namespace {
+    /// Dependency graph between the glob imports of local modules
+    struct GlobGraph
+    {
+        /// All local modules in tree order (mutable handles for the `const` pointers in path bindings)
+        ::std::vector<AST::Module*> order;
+        ::std::map<const AST::Module*, AST::Module*>    modules;
+        /// Modules currently being populated (re-entering one means there's a glob cycle)
+        ::std::set<const AST::Module*>  active;
+        /// Modules with all of their globs processed
+        ::std::set<const AST::Module*>  done;
+
+        void add_modules(AST::Module& mod)
+        {
+            order.push_back(&mod);
+            modules.insert( ::std::make_pair(&mod, &mod) );
+            for( auto& i : mod.items() )
+            {
+                if( auto* e = i.data.opt_Module() )
+                {
+                    add_modules(*e);
+                }
+            }
+            for(auto& mp : mod.anon_mods())
+            {
+                if( mp ) {
+                    add_modules(*mp);
+                }
+            }
+        }
+
+        void populate(AST::Crate& crate, AST::Module& mod)
+        {
+            if( done.count(&mod) )
+                return ;
+            if( ! active.insert(&mod).second )
+            {
+                // Cycles are left to the recursion in `Resolve_Index_Module_Wildcard__submod`
+                DEBUG("Glob cycle through " << mod.path());
+                return ;
+            }
+            TRACE_FUNCTION_F("mod = " << mod.path());
+
+            // Complete the local modules this one globs from first, so their index can be copied as-is
+            for( const auto& i : mod.items() )
+            {
+                if( ! i.data.is_Use() )
+                    continue ;
+                if( i.name != "" )
+                    continue ;
+                const auto& b = i.data.as_Use().path.binding();
+                if( b.is_Module() && b.as_Module().module_ )
+                {
+                    auto it = modules.find(b.as_Module().module_);
+                    if( it != modules.end() )
+                    {
+                        populate(crate, *it->second);
+                    }
+                }
+            }
+
+            for( const auto& i : mod.items() )
+            {
+                if( ! i.data.is_Use() )
+                    continue ;
+                if( i.name != "" )
+                    continue ;
+                Resolve_Index_Module_Wildcard__use_stmt(crate, mod, i.data.as_Use(), i.is_pub);
+            }
+
+            // Mark this as having all the items it ever will.
+            mod.m_index_populated = 2;
+            active.erase(&mod);
+            done.insert(&mod);
+        }
+    };
+}
+
 // Wildcard (aka glob) import resolution
 //
 // Strategy:
 // - HIR just imports the items
 // - Enums import all variants
-// - AST modules: (See Resolve_Index_Module_Wildcard__submod)
+// - AST modules: Populated in dependency order (sources before the modules that glob from them)
 //  - Clone index in (marked as publicity and weak)
-//  - Recurse into globs
+//  - Only glob cycles need to recurse into the source's globs (See Resolve_Index_Module_Wildcard__submod)
 void Resolve_Index_Module_Wildcard(AST::Crate& crate, AST::Module& mod)
 {
-    TRACE_FUNCTION_F("mod = " << mod.path());
-    for( const auto& i : mod.items() )
-    {
-        if( ! i.data.is_Use() )
-            continue ;
-        if( i.name != "" )
-            continue ;
-        Resolve_Index_Module_Wildcard__use_stmt(crate, mod, i.data.as_Use(), i.is_pub);
-    }
-
-    // Mark this as having all the items it ever will.
-    mod.m_index_populated = 2;
+    GlobGraph   graph;
+    graph.add_modules(mod);
 
-    // Handle child modules
-    for( auto& i : mod.items() )
+    for(auto* m : graph.order)
     {
-        if( auto* e = i.data.opt_Module() )
-        {
-            Resolve_Index_Module_Wildcard(crate, *e);
-        }
-    }
-    for(auto& mp : mod.anon_mods())
-    {
-        if( mp ) {
-            Resolve_Index_Module_Wildcard(crate, *mp);
-        }
+        graph.populate(crate, *m);
     }
 }
 
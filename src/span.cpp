@@ -7,57 +7,223 @@
  */
 #include <functional>
 #include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 #include <span.hpp>
 #include <parse/lex.hpp>
 #include <common.hpp>
 
-Span::Span(const Span& x):
-    filename(x.filename),
-    start_line(x.start_line),
-    start_ofs(x.start_ofs),
-    end_line(x.end_line),
-    end_ofs(x.end_ofs)
+namespace {
+    /// Global table of all source locations, indexed by `Span::m_idx`
+    ///
+    /// Both tables are append-only arrays of fixed-size blocks, so an entry never moves once written and lookups don't
+    /// need a lock. Spans are created from parser worker threads, so each thread fills its own block of locations and
+    /// only allocating a new block touches shared state. Adding a file takes a lock, but only happens once per file.
+    struct SourceMap
+    {
+        struct Location {
+            unsigned int    file;
+            unsigned int    start_line;
+            unsigned int    start_ofs;
+            unsigned int    end_line;
+            unsigned int    end_ofs;
+
+            bool operator==(const Location& x) const {
+                return file == x.file
+                    && start_line == x.start_line && start_ofs == x.start_ofs
+                    && end_line == x.end_line && end_ofs == x.end_ofs;
+            }
+        };
+        static const unsigned int LOC_BLOCK_BITS = 14;
+        static const unsigned int LOC_BLOCK_SIZE = 1u << LOC_BLOCK_BITS;
+        static const unsigned int MAX_LOC_BLOCKS = 1u << (32 - LOC_BLOCK_BITS);
+        static const unsigned int FILE_BLOCK_BITS = 8;
+        static const unsigned int FILE_BLOCK_SIZE = 1u << FILE_BLOCK_BITS;
+        static const unsigned int MAX_FILE_BLOCKS = 1024;
+
+        /// Block of locations being filled by the current thread (`next == end` when a new one is needed)
+        struct ThreadBlock {
+            uint32_t    start = 0;
+            uint32_t    next = 0;
+            uint32_t    end = 0;
+        };
+        static thread_local ThreadBlock t_block;
+        /// Last file looked up by the current thread (spans are created in runs from the same file)
+        static thread_local unsigned int    t_last_file;
+
+        ::std::atomic<Location*>    m_loc_blocks[MAX_LOC_BLOCKS];
+        ::std::atomic<uint32_t> m_next_loc_block;
+
+        ::std::atomic<RcString*>    m_file_blocks[MAX_FILE_BLOCKS];
+        /// Guards adding to the file table (`m_file_lookup` and `m_file_count`)
+        ::std::mutex    m_files_lock;
+        ::std::unordered_map<RcString, unsigned int>  m_file_lookup;
+        unsigned int    m_file_count;
+
+        SourceMap():
+            m_next_loc_block(1),
+            m_file_count(0)
+        {
+            for(auto& b : m_loc_blocks)
+                b = nullptr;
+            for(auto& b : m_file_blocks)
+                b = nullptr;
+            // Index zero of both tables is the empty span (the rest of the first location block is unused)
+            m_loc_blocks[0] = new Location[1] { Location { 0, 0,0, 0,0 } };
+            add_file( RcString("") );
+        }
+
+        unsigned int add_file(const RcString& name)
+        {
+            auto idx = m_file_count;
+            if( idx % FILE_BLOCK_SIZE == 0 )
+            {
+                if( idx / FILE_BLOCK_SIZE == MAX_FILE_BLOCKS ) {
+                    ::std::cerr << "BUG: Source map file table is full" << ::std::endl;
+                    abort();
+                }
+                m_file_blocks[idx / FILE_BLOCK_SIZE] = new RcString[FILE_BLOCK_SIZE];
+            }
+            m_file_blocks[idx / FILE_BLOCK_SIZE].load()[idx % FILE_BLOCK_SIZE] = name;
+            m_file_lookup.insert( ::std::make_pair(name, idx) );
+            m_file_count = idx + 1;
+            return idx;
+        }
+        unsigned int get_file(const RcString& name)
+        {
+            if( get_file_name(t_last_file) == name )
+                return t_last_file;
+            ::std::lock_guard< ::std::mutex>    lh(m_files_lock);
+            auto it = m_file_lookup.find( name );
+            t_last_file = (it != m_file_lookup.end() ? it->second : add_file(name));
+            return t_last_file;
+        }
+        uint32_t add(unsigned int file, unsigned int start_line, unsigned int start_ofs, unsigned int end_line, unsigned int end_ofs)
+        {
+            Location    loc { file, start_line, start_ofs, end_line, end_ofs };
+            if( loc == get(0) )
+                return 0;
+            auto& tb = t_block;
+            // - Nodes parsed from the same token share the same location, don't duplicate them
+            if( tb.next != tb.start && get(tb.next - 1) == loc )
+                return tb.next - 1;
+            if( tb.next == tb.end )
+            {
+                auto blk = m_next_loc_block ++;
+                if( blk >= MAX_LOC_BLOCKS ) {
+                    ::std::cerr << "BUG: Source map location table is full" << ::std::endl;
+                    abort();
+                }
+                m_loc_blocks[blk] = new Location[LOC_BLOCK_SIZE];
+                tb.start = tb.next = blk << LOC_BLOCK_BITS;
+                tb.end = tb.start + LOC_BLOCK_SIZE;
+            }
+            auto idx = tb.next ++;
+            m_loc_blocks[idx >> LOC_BLOCK_BITS].load()[idx & (LOC_BLOCK_SIZE-1)] = loc;
+            return idx;
+        }
+        const Location& get(uint32_t idx) const
+        {
+            const auto* blk = m_loc_blocks[idx >> LOC_BLOCK_BITS].load();
+            assert(blk);
+            return blk[idx & (LOC_BLOCK_SIZE-1)];
+        }
+        const RcString& get_file_name(unsigned int file) const
+        {
+            const auto* blk = m_file_blocks[file / FILE_BLOCK_SIZE].load();
+            assert(blk);
+            return blk[file % FILE_BLOCK_SIZE];
+        }
+    };
+    thread_local SourceMap::ThreadBlock SourceMap::t_block;
+    thread_local unsigned int   SourceMap::t_last_file = 0;
+
+    SourceMap& source_map()
+    {
+        static SourceMap    s_map;
+        return s_map;
+    }
+}
+
+Span::Span(RcString filename, unsigned int start_line, unsigned int start_ofs,  unsigned int end_line, unsigned int end_ofs):
+    m_idx( source_map().add(source_map().get_file(filename), start_line, start_ofs, end_line, end_ofs) )
+{
+}
+Span::Span(uint32_t file, unsigned int start_line, unsigned int start_ofs,  unsigned int end_line, unsigned int end_ofs):
+    m_idx( source_map().add(file, start_line, start_ofs, end_line, end_ofs) )
 {
 }
 Span::Span(const Position& pos):
-    filename(pos.filename),
-    start_line(pos.line),
-    start_ofs(pos.ofs),
-    end_line(pos.line),
-    end_ofs(pos.ofs)
+    m_idx( source_map().add(pos.file, pos.line, pos.ofs, pos.line, pos.ofs) )
 {
 }
 Span::Span():
-    filename("")/*,
-    start_line(0), start_ofs(0),
-    end_line(0), end_ofs(0) // */
+    m_idx(0)
 {
     DEBUG("Empty span");
     //filename = FMT(":" << __builtin_return_address(0));
 }
 
+uint32_t Span::intern_file(const RcString& filename) {
+    return source_map().get_file(filename);
+}
+const RcString& Span::file_name(uint32_t file) {
+    return source_map().get_file_name(file);
+}
+
+const RcString& Span::filename() const {
+    return source_map().get_file_name( source_map().get(m_idx).file );
+}
+unsigned int Span::start_line() const {
+    return source_map().get(m_idx).start_line;
+}
+unsigned int Span::start_ofs() const {
+    return source_map().get(m_idx).start_ofs;
+}
+unsigned int Span::end_line() const {
+    return source_map().get(m_idx).end_line;
+}
+unsigned int Span::end_ofs() const {
+    return source_map().get(m_idx).end_ofs;
+}
+
+namespace {
+    /// Print a fatal error and stop
+    /// - If the current thread's error output is redirected (a parser worker), the error is thrown instead so that
+    ///   the owner of the redirect can decide which error to report.
+    void fatal_error(const ::std::string& msg)
+    {
+        if( CompileError::output_redirected() )
+            throw CompileError::Fatal(msg);
+        ::std::cerr << msg << ::std::endl;
+        abort();
+    }
+}
+
 void Span::bug(::std::function<void(::std::ostream&)> msg) const
 {
-    ::std::cerr << this->filename << ":" << this->start_line << ": BUG:";
-    msg(::std::cerr);
-    ::std::cerr << ::std::endl;
-    abort();
+    ::std::stringstream ss;
+    ss << this->filename() << ":" << this->start_line() << ": BUG:";
+    msg(ss);
+    fatal_error(ss.str());
 }
 
 void Span::error(ErrorType tag, ::std::function<void(::std::ostream&)> msg) const {
-    ::std::cerr << this->filename << ":" << this->start_line << ": error:" << tag <<":";
-    msg(::std::cerr);
-    ::std::cerr << ::std::endl;
-    abort();
+    ::std::stringstream ss;
+    ss << this->filename() << ":" << this->start_line() << ": error:" << tag <<":";
+    msg(ss);
+    fatal_error(ss.str());
 }
 void Span::warning(WarningType tag, ::std::function<void(::std::ostream&)> msg) const {
-    ::std::cerr << this->filename << ":" << this->start_line << ": warning:" << tag << ":";
+    ::std::cerr << this->filename() << ":" << this->start_line() << ": warning:" << tag << ":";
     msg(::std::cerr);
     ::std::cerr << ::std::endl;
     //abort();
 }
 void Span::note(::std::function<void(::std::ostream&)> msg) const {
-    ::std::cerr << this->filename << ":" << this->start_line << ": note:";
+    ::std::cerr << this->filename() << ":" << this->start_line() << ": note:";
     msg(::std::cerr);
     ::std::cerr << ::std::endl;
     //abort();
@@ -65,6 +231,6 @@ void Span::note(::std::function<void(::std::ostream&)> msg) const {
 
 ::std::ostream& operator<<(::std::ostream& os, const Span& sp)
 {
-    os << sp.filename << ":" << sp.start_line;
+    os << sp.filename() << ":" << sp.start_line();
     return os;
 }